@@ -4,33 +4,36 @@ to calculate the determinant of a square matrix using
 Gaussian elimination with pivoting by the maximum absolute element. 
 After each permutation or elimination step, it prints the updated 
 matrix and the step type. Finally, it outputs the determinant formatted to two decimal places.
+With --no-steps only the determinant is printed, computed by a parallel tiled LU,
+and `--no-steps A.bin` reads A from a binary matrix file.
 */
 
-#include <iostream>
-#include <vector>
-#include <iomanip>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <cstring>
+
+#include "matrix_io.h"
+#include "matrix_lu.h"
+#include "matrix_batch.h"
+#include "matrix_file.h"
 
 using namespace std;
+
 class Matrix
 {
 public:
     int n;
-    vector<vector<double>> array;
+    DenseStorage<double> array;
     Matrix(int n)
     {
         this->n = n;
-        this->array = vector<vector<double>>(n, vector<double>(n));
+        this->array = DenseStorage<double>(n, n);
     }
 
     void input()
     {
-        for (int i = 0; i < n; i++)
-        {
-            for (int j = 0; j < n; j++)
-            {
-                cin >> array[i][j];
-            }
-        }
+        stdinReader().readBlock(array.getData(), n, n, array.getStride());
     }
 
     void output()
@@ -39,10 +42,10 @@ public:
         {
             for (int j = 0; j < n - 1; j++)
             {
-                cout << fixed << setprecision(2) <<array[i][j] << " ";
+                stdoutWriter() << Fixed{array[i][j], 2} << " ";
             }
-            cout << fixed << setprecision(2) << array[i][n - 1];
-            cout << '\n';
+            stdoutWriter() << Fixed{array[i][n - 1], 2};
+            stdoutWriter() << '\n';
         }
     }
 
@@ -50,7 +53,7 @@ public:
     {
         if (q != w)
         {
-            swap(array[q], array[w]);
+            array.swapRows(q, w);
         }
     }
 
@@ -67,7 +70,7 @@ public:
                 {
                     array[i][j] -= k * array[col][j];
                 }
-                cout << "step #" << st << ": elimination" << endl;
+                stdoutWriter() << "step #" << st << ": elimination" << '\n';
                 output();
                 st++;
             }
@@ -83,9 +86,10 @@ public:
         for (int count = 0; count < n; count++) { // counter for column detection
             double mx = 0;
             int temp = 0;
+            ColumnView<double> pivotColumn = array.column(column);
             for (int i = count; i < n; i++) {
-                if (abs(array[i][column]) > mx) {
-                    mx = abs(array[i][column]);
+                if (abs(pivotColumn[i]) > mx) {
+                    mx = abs(pivotColumn[i]);
                     temp = i;
                 }
             }
@@ -94,7 +98,7 @@ public:
 
                 makePermutation(temp, count);
                 st += 1;
-                cout << "step #" << step << ": permutation" << endl;
+                stdoutWriter() << "step #" << step << ": permutation" << '\n';
                 output();
                 step ++;
             }
@@ -110,29 +114,84 @@ public:
         {
             det *= array[i][i];
         }
-        cout << "result:" << endl;
+        stdoutWriter() << "result:" << '\n';
         if (det == 0)
         {
-            cout << fixed << setprecision(2) << abs(det);
+            stdoutWriter() << Fixed{abs(det), 2};
         } else
         {
             if (flag)
             {
-                cout << fixed << setprecision(2) << det;
+                stdoutWriter() << Fixed{det, 2};
             } else
             {
-                cout << fixed << setprecision(2) << det * (-1);
+                stdoutWriter() << Fixed{det * (-1), 2};
             }
         }
     }
 };
 
-int main()
+int main(int argc, char* argv[])
 {
-    int n;
-    cin >> n;
+    if (getenv("MATRIX_THREADS"))
+    {
+        LUFactorization::threads = max(1, atoi(getenv("MATRIX_THREADS")));
+        MatrixBatch::threads = LUFactorization::threads;
+    }
+    if (getenv("MATRIX_SINGULAR_TOLERANCE"))
+    {
+        LUFactorization::tolerance = atof(getenv("MATRIX_SINGULAR_TOLERANCE"));
+    }
+
+    // determinant_calculator --batch: "count n" and count n x n matrices,
+    // one determinant per line
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0)
+    {
+        int count, n;
+        stdinReader() >> count >> n;
+        MatrixBatch A(n, n, count);
+        for (int b = 0; b < count; b++)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                for (int j = 0; j < n; j++) stdinReader() >> A.at(b, i, j);
+            }
+        }
+        for (double det : A.determinants())
+        {
+            stdoutWriter() << Fixed{det == 0 ? abs(det) : det, 2} << '\n';
+        }
+        return 0;
+    }
+
+    // determinant_calculator --no-steps [A.bin]: only the result, from the
+    // parallel tiled LU; A comes from a binary matrix file when one is named
+    bool steps = !(argc > 1 && strcmp(argv[1], "--no-steps") == 0);
+    bool fromFile = !steps && argc > 2;
+    int n = 0;
+    if (!fromFile) stdinReader() >> n;
     Matrix A(n); // temporary matrix
-    A.input();
+    if (fromFile)
+    {
+        A.array = readMatrixFile<double>(argv[2]);
+        A.n = A.array.getRows();
+        if (A.array.getCols() != A.n)
+        {
+            stdoutWriter() << "Error: the dimensional problem occurred";
+            return 0;
+        }
+    } else
+    {
+        A.input();
+    }
+
+    if (!steps)
+    {
+        double det = LUFactorization(A.array).determinant();
+        stdoutWriter() << "result:" << '\n';
+        stdoutWriter() << Fixed{det == 0 ? abs(det) : det, 2};
+        return 0;
+    }
     int st = A.upperTriangular();
     if (st % 2 != 0)
     {
@@ -6,50 +6,38 @@ the augmented matrix, then performs and displays each elimination
 and normalization step with labels. If the matrix is singular, 
 it prints “Error: matrix A is singular.” 
 All results are printed with two decimal places.
+With --batch it inverts (or solves with) many small matrices at once,
+with --no-steps it prints only the result, taken from one LU factorization,
+and `--no-steps A.bin` reads A from a binary matrix file.
 */
 
-#include <iostream>
 #include <vector>
-#include <iomanip>
+#include <cstdlib>
+#include <algorithm>
+#include <cstring>
+
+#include "matrix_io.h"
+#include "matrix_augmented.h"
+#include "matrix_lu.h"
+#include "matrix_batch.h"
+#include "matrix_file.h"
 
 using namespace std;
+
 class Matrix
 {
 public:
     int n;
-    vector<vector<double>> array;
+    DenseStorage<double> array;
     Matrix(int n)
     {
         this->n = n;
-        this->array = vector<vector<double>>(n, vector<double>(n));
+        this->array = DenseStorage<double>(n, n);
     }
 
     void input()
     {
-        for (int i = 0; i < n; i++)
-        {
-            for (int j = 0; j < n; j++)
-            {
-                cin >> array[i][j];
-            }
-        }
-    }
-
-    void output(vector<vector<double>> tempArr)
-    {
-        for (int i = 0; i < n; i++)
-        {
-            for (int j = 0; j < n; j++)
-            {
-                cout << fixed << setprecision(2) << array[i][j] << " ";
-            }
-            for (int j = 0; j < n - 1; j++)
-            {
-                cout << fixed << setprecision(2) << tempArr[i][j] << " ";
-            }
-            cout << fixed << setprecision(2) << tempArr[i][n - 1];
-            cout << '\n';
-        }
+        stdinReader().readBlock(array.getData(), n, n, array.getStride());
     }
 
     void output()
@@ -58,215 +46,161 @@ public:
         {
             for (int j = 0; j < n - 1; j++)
             {
-                cout << fixed << setprecision(2) << array[i][j] << " ";
+                stdoutWriter() << Fixed{array[i][j], 2} << " ";
             }
-            cout << fixed << setprecision(2) << array[i][n - 1];
-            cout << '\n';
+            stdoutWriter() << Fixed{array[i][n - 1], 2};
+            stdoutWriter() << '\n';
         }
     }
 
-    void makePermutation1(int q, int w)
+    void setArray(DenseStorage<double> t)
     {
-        if (q != w)
-        {
-            swap(array[q], array[w]);
-        }
+        array = std::move(t);
     }
 
-    void makeElimination1(int col)
+    DenseStorage<double>& getArray()
     {
-        for (int i = col+1; i < n; i++) // walk through the rows
-        {
-            double k = array[i][col] / array[col][col];
-            if (array[i][col] != 0)
-            {
-                for (int j = 0; j < n; j++)
-                {
-                    array[i][j] -= k * array[col][j];
-                }
-            }
-        }
+        return array;
     }
 
-    void upperTriangular()
+    const DenseStorage<double>& getArray() const
     {
-        int column = 0;
-        for (int count = 0; count < n; count++) { // counter for column detection
-            double mx = 0;
-            int temp = 0;
-            for (int i = count; i < n; i++) {
-                if (abs(array[i][column]) > mx) {
-                    mx = abs(array[i][column]);
-                    temp = i;
-                }
-            }
-            column += 1;
-            if (temp > 0 && abs(mx) != abs(array[count][count])) {
-
-                makePermutation1(temp, count);
-            }
-            makeElimination1(count);
-        }
+        return array;
     }
 
-    void setArray(vector<vector<double>> t)
+    Matrix(const Matrix& ma) = default;
+    Matrix(Matrix&& ma) = default;
+
+    Matrix& operator=(const Matrix& ma)
     {
-        array = std::move(t);
+        array = ma.array;
+        n = ma.n;
+        return *this;
     }
 
-    vector<vector<double>> getArray()
+    Matrix& operator=(Matrix&& ma)
     {
-        return array;
+        array = std::move(ma.array);
+        n = ma.n;
+        return *this;
     }
+};
 
-    vector<vector<double>> makePermutation(int q, int w, vector<vector<double>> tempArr)
+class IdentityMatrix : public Matrix
+{
+public:
+    IdentityMatrix(int n) : Matrix(n)
     {
-        if (q != w)
+        this->n = n;
+        for (int i = 0; i < n; i++)
         {
-            swap(tempArr[q], tempArr[w]);
-            swap(array[q], array[w]);
+            array[i][i]=1;
         }
-        return tempArr;
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    if (getenv("MATRIX_THREADS"))
+    {
+        MatrixBatch::threads = max(1, atoi(getenv("MATRIX_THREADS")));
+        LUFactorization::threads = MatrixBatch::threads;
+    }
+    if (getenv("MATRIX_SINGULAR_TOLERANCE"))
+    {
+        LUFactorization::tolerance = atof(getenv("MATRIX_SINGULAR_TOLERANCE"));
     }
 
-    vector<vector<double>> makeElimination(int col, vector<vector<double>> tempArr, bool flag)
+    // inverse_matrix_calculator --batch: "count n" and count n x n matrices.
+    // Prints every inverse, or, when count vectors b follow the matrices,
+    // every solution of A * x = b on one line.
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0)
     {
-        if (flag)
+        int count, n;
+        stdinReader() >> count >> n;
+        MatrixBatch A(n, n, count);
+        for (int b = 0; b < count; b++)
         {
-            for (int i = col+1; i < n; i++) // walk through the rows
+            for (int i = 0; i < n; i++)
             {
-                double k = array[i][col] / array[col][col];
-                if (array[i][col] != 0)
-                {
-                    for (int j = 0; j < n; j++)
-                    {
-                        tempArr[i][j] -= k * tempArr[col][j];
-                        array[i][j] -= k * array[col][j];
-                    }
-                    cout << "step #" << step << ": elimination" << endl;
-                    output(tempArr);
-                    step++;
-                }
+                for (int j = 0; j < n; j++) stdinReader() >> A.at(b, i, j);
             }
-        } else {
-            for (int g = col - 1; g >= 0; g--) // walk through the rows
+        }
+        bool solving = stdinReader().hasMore();
+        MatrixBatch rhs(n, 1, solving ? count : 0);
+        for (int b = 0; b < rhs.count; b++)
+        {
+            for (int i = 0; i < n; i++) stdinReader() >> rhs.at(b, i, 0);
+        }
+        vector<double> det;
+        MatrixBatch x = solving ? A.solve(rhs, det) : A.inverses(det);
+        for (int b = 0; b < count; b++)
+        {
+            if (det[b] == 0)
             {
-                double k = array[g][col] / array[col][col];
-                if (array[g][col] != 0) {
-                    for (int j = n - 1; j >= 0; j--) {
-                        tempArr[g][j] -= k * tempArr[col][j];
-                        array[g][j] -= k * array[col][j];
-                    }
-                    cout << "step #" << step << ": elimination" << endl;
-                    output(tempArr);
-                    step++;
-                }
+                stdoutWriter() << "Error: matrix A is singular" << '\n';
+                continue;
             }
-        }
-        return tempArr;
-    }
-
-    // array[i][j] - k * array[i-1][j]
-    // array[i][j] - k * array[i-1][j] = 0 => k = array[i][j] / array[i-1][j]
-    int step = 1;
-    vector<vector<double>> GaussianProcess(vector<vector<double>> tempArray)
-    {
-        int column = 0;
-        for (int count = 0; count < n; count++) { // counter for column detection
-            double mx = 0;
-            int temp = 0;
-            for (int i = count; i < n; i++) {
-                if (abs(array[i][column]) > mx) {
-                    mx = abs(array[i][column]);
-                    temp = i;
+            for (int i = 0; i < n; i++)
+            {
+                for (int j = 0; j < x.cols; j++)
+                {
+                    stdoutWriter() << Fixed{x.at(b, i, j), 2} << (j < x.cols - 1 ? " " : "");
                 }
+                stdoutWriter() << (solving && i < n - 1 ? ' ' : '\n');
             }
-            column += 1;
-            if (temp > 0 && abs(mx) != abs(array[count][count])) {
-                tempArray = makePermutation(temp, count, tempArray);
-                cout << "step #" << step << ": permutation" << endl;
-                output(tempArray);
-                step++;
-            }
-            tempArray = makeElimination(count, tempArray, true);
         }
-        // reversed
-        for (int count = n - 1; count > 0; count--) { // counter for column detection
-            tempArray = makeElimination(count, tempArray, false);
-        }
-        return tempArray;
+        return 0;
     }
 
-    void findDeterminant()
+    // inverse_matrix_calculator --no-steps [A.bin]: A comes from a binary
+    // matrix file when one is named
+    bool steps = !(argc > 1 && strcmp(argv[1], "--no-steps") == 0);
+    bool fromFile = !steps && argc > 2;
+    int n = 0;
+    if (!fromFile) stdinReader() >> n;
+    Matrix A(n); // temporary matrix
+    if (fromFile)
     {
-        double det = 1;
-        for (int i = 0; i < n; i++)
+        A.array = readMatrixFile<double>(argv[2]);
+        A.n = n = A.array.getRows();
+        if (A.array.getCols() != n)
         {
-            det *= array[i][i];
+            stdoutWriter() << "Error: the dimensional problem occurred";
+            return 0;
         }
-        if (det == 0)
-        {
-            cout << "Error: matrix A is singular";
-            exit(0);
-        }
-    }
-
-    vector<vector<double>> diagonalNormalization(vector<vector<double>> tempArray)
+    } else
     {
-        for (int i = 0; i < n; i++)
-        {
-            double k = array[i][i];
-            for (int j = 0; j < n; j++)
-            {
-                array[i][j] /= k;
-                tempArray[i][j] /= k;
-            }
-        }
-        cout << "Diagonal normalization:" << endl;
-        output(tempArray);
-        return tempArray;
+        A.input();
     }
 
-    void operator=(const Matrix& ma)
+    // one factorization rejects a singular A; without steps it is the inverse too
+    LUFactorization lu(A.getArray());
+    if (lu.isSingular() || lu.determinant() == 0)
     {
-        array = ma.array;
-        n = ma.n;
+        stdoutWriter() << "Error: matrix A is singular";
+        return 0;
     }
-};
-
-class IdentityMatrix : public Matrix
-{
-public:
-    IdentityMatrix(int n) : Matrix(n)
+    if (!steps)
     {
-        this->n = n;
-        for (int i = 0; i < n; i++)
-        {
-            array[i][i]=1;
-        }
+        A.setArray(lu.inverse());
+        stdoutWriter() << "Result:" << '\n';
+        A.output();
+        return 0;
     }
-};
-
-int main()
-{
-    int n;
-    cin >> n;
-    Matrix A(n); // temporary matrix
-    A.input();
-
-    Matrix TempMatrix(n);
-    TempMatrix = A;
-    TempMatrix.upperTriangular();
-    TempMatrix.findDeterminant();
     IdentityMatrix identityArray(n);
 
-    cout << "Augmented matrix:" << endl;
-    A.output(identityArray.getArray());
+    stdoutWriter() << "Augmented matrix:" << '\n';
+    AugmentedMatrix augmented(A.getArray(), identityArray.getArray(), 2,
+                              AugmentedMatrix::TRACE_PERMUTATIONS | AugmentedMatrix::TRACE_ELIMINATIONS | AugmentedMatrix::TRACE_NORMALIZATION);
+    augmented.output();
 
-    cout << "Gaussian process:" << endl;
-    A.setArray(A.diagonalNormalization(A.GaussianProcess(identityArray.getArray())));
+    stdoutWriter() << "Gaussian process:" << '\n';
+    augmented.GaussianProcess();
+    augmented.diagonalNormalization();
+    A.setArray(augmented.right());
 
-    cout << "Result:" << endl;
+    stdoutWriter() << "Result:" << '\n';
     A.output();
     return 0;
 }
@@ -7,23 +7,32 @@ it prints an error message. Otherwise, it computes the decomposition
 into (\alpha) and (\beta), iteratively approximates the solution vectors (x_i), 
 prints each iteration with its current accuracy (e), and finally outputs 
 the approximate solution (\tilde{x}). All numbers are formatted to four decimal places.
+With --sparse, A is read as CSR triplets and every sweep costs O(nnz).
 */
 
-#include <iostream>
 #include <vector>
-#include <iomanip>
 #include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
+#include <memory>
+#include <cstring>
+
+#include "matrix_io.h"
+#include "matrix_threads.h"
+#include "matrix_sparse.h"
 
 using namespace std;
+
 class Matrix
 {
 public:
     int n;
-    vector<vector<double>> array;
+    DenseStorage<double> array;
     Matrix(int n)
     {
         this->n = n;
-        this->array = vector<vector<double>>(n, vector<double>(n));
+        this->array = DenseStorage<double>(n, n);
 
         // filling the vector with "empty" values (NaN)
         for (int i = 0; i < n; i++)
@@ -43,13 +52,7 @@ public:
 
     virtual void input()
     {
-        for (int i = 0; i < n; i++)
-        {
-            for (int j = 0; j < n; j++)
-            {
-                cin >> array[i][j];
-            }
-        }
+        stdinReader().readBlock(array.getData(), n, n, array.getStride());
     }
 
     void output()
@@ -60,14 +63,14 @@ public:
             {
                 if (!isnan(this->array[i][j]))
                 {
-                    cout << fixed << setprecision(4) << array[i][j] << " ";
+                    stdoutWriter() << Fixed{array[i][j], 4} << " ";
                 }
             }
             if (!isnan(this->array[i][n - 1]))
             {
-                cout << fixed << setprecision(4) << array[i][n - 1];
+                stdoutWriter() << Fixed{array[i][n - 1], 4};
             }
-            cout << '\n';
+            stdoutWriter() << '\n';
         }
     }
 };
@@ -77,27 +80,28 @@ class ColumnVector : public Matrix
 private:
     vector<double> vectorArr;
 public:
-    ColumnVector(int n) : Matrix(n)
+    // workers of the sparse Jacobi sweeps; set from MATRIX_THREADS in main()
+    static int threads;
+
+    ColumnVector(int n) : Matrix(0)
     {
+        this->n = n;
         this->vectorArr = vector<double>(n);
     }
 
     void input() override
     {
-        for (int i = 0; i < n; i++)
-        {
-            cin >> vectorArr[i];
-        }
+        stdinReader().readBlock(vectorArr.data(), 1, n, n);
     }
 
     void outputVector()
     {
         for (int j = 0; j < n - 1; j++)
         {
-            cout << fixed << setprecision(4) << vectorArr[j] << endl;
+            stdoutWriter() << Fixed{vectorArr[j], 4} << '\n';
         }
-        cout << fixed << setprecision(4) << vectorArr[n - 1];
-        cout << '\n';
+        stdoutWriter() << Fixed{vectorArr[n - 1], 4};
+        stdoutWriter() << '\n';
     }
 
     ColumnVector operator-(const ColumnVector& vector) {
@@ -114,6 +118,16 @@ public:
         return result;
     }
 
+    ColumnVector& operator+=(const ColumnVector& vector) {
+        for (int i = 0; i < n; i++) vectorArr[i] += vector.vectorArr[i];
+        return *this;
+    }
+
+    ColumnVector& operator-=(const ColumnVector& vector) {
+        for (int i = 0; i < n; i++) vectorArr[i] -= vector.vectorArr[i];
+        return *this;
+    }
+
     ColumnVector operator*(const Matrix& matrix)
     {
         ColumnVector result(n);
@@ -127,6 +141,13 @@ public:
         return result;
     }
 
+    ColumnVector operator*(const SparseMatrix& matrix)
+    {
+        ColumnVector result(n);
+        matrix.multiply(vectorArr.data(), result.vectorArr.data(), 0, matrix.n);
+        return result;
+    }
+
     double condition(const ColumnVector& vector) {
         ColumnVector tempVector(n);
         tempVector = this->operator-(vector);
@@ -139,8 +160,8 @@ public:
 
     void JacobiMethod(const Matrix& A, double e) {
         int size = A.n;
-        vector<vector<double>> array;
-        vector<vector<double>> a = A.array;
+        DenseStorage<double> array;
+        const DenseStorage<double>& a = A.array;
         vector<double> b = vectorArr;
         vector<double> beta = vector<double>(size, 0);
         // Let's express from all the rows the xᵢ:
@@ -151,12 +172,12 @@ public:
                 if (i != j) sum += abs(a[i][j]);
             }
             if (sum >= abs(a[i][i])) {
-                cout << "The method is not applicable";
+                stdoutWriter() << "The method is not applicable";
                 exit(0);
             }
         }
         // αᵢⱼ = -аᵢⱼ / аᵢᵢ
-        vector<vector<double>> alpha = vector<vector<double>>(size, vector<double>(size, 0));
+        DenseStorage<double> alpha = DenseStorage<double>(size, size, 0);
         for (int i = 0; i < size; i++) {
             for (int j = 0; j < size; j++) {
                 if (i != j) alpha[i][j] = -a[i][j] / a[i][i];
@@ -166,47 +187,149 @@ public:
         ColumnVector xARRAY1(n);
         ColumnVector xARRAY2(n);
         Matrix MatrixALPHA(n);
-        MatrixALPHA.array = alpha;
-        cout << "alpha:" << endl;
+        MatrixALPHA.array = std::move(alpha);
+        stdoutWriter() << "alpha:" << '\n';
         MatrixALPHA.output();
         ColumnVector VectorBETA(n);
         VectorBETA.vectorArr = beta;
-        cout << "beta:" << endl;
+        stdoutWriter() << "beta:" << '\n';
         VectorBETA.outputVector();
+        // the sweeps only touch the non-zeros of alpha
+        SparseMatrix SparseALPHA = SparseMatrix::fromDense(MatrixALPHA.array, n);
 
         xARRAY1.vectorArr = beta;
         int k = 1;
-        xARRAY2 = xARRAY1*MatrixALPHA+VectorBETA;
+        xARRAY2 = xARRAY1*SparseALPHA+VectorBETA;
         ColumnVector Answer(n);
         Answer.vectorArr = xARRAY2.vectorArr;
         double ex = xARRAY2.condition(xARRAY1);
         while (ex > e) {
-            cout << "x(" << k << ")" << endl;
+            stdoutWriter() << "x(" << k << ")" << '\n';
             k += 1;
             xARRAY2.outputVector();
             ex = xARRAY2.condition(xARRAY1);
-            cout << "e: " << fixed << setprecision(4) << ex << endl;
+            stdoutWriter() << "e: " << Fixed{ex, 4} << '\n';
             Answer.vectorArr = xARRAY2.vectorArr;
             xARRAY1.vectorArr = xARRAY2.vectorArr;
-            xARRAY2 = xARRAY1*MatrixALPHA+VectorBETA;
+            xARRAY2 = xARRAY1*SparseALPHA+VectorBETA;
         }
-        cout << "x~:" << endl;
+        stdoutWriter() << "x~:" << '\n';
+        Answer.outputVector();
+    }
+
+    // Jacobi on a sparse A: every sweep is O(nnz). alpha and the iterates
+    // are too large to print, so only e of each sweep and x~ are shown.
+    // The sweeps run on `threads` workers that live for the whole solve.
+    // Each worker owns a contiguous block of rows with about the same
+    // number of non-zeros and first touches its part of both iterate
+    // buffers. A sweep reads one buffer and writes the other, and the
+    // update is fused with the worker's share of ||x(k+1) - x(k)||^2. The
+    // barrier at the end of a sweep is the only synchronization: after it
+    // every worker adds up the same shares and makes the same stop decision.
+    void SparseJacobiMethod(const SparseMatrix& A, double e) {
+        int size = A.n;
+        SparseMatrix alpha;
+        vector<double> beta;
+        if (!A.jacobiSplit(vectorArr, alpha, beta)) {
+            stdoutWriter() << "The method is not applicable";
+            exit(0);
+        }
+
+        int workers = max(1, min(threads, size));
+        vector<int> bounds(workers + 1, size);
+        bounds[0] = 0;
+        for (int t = 1, i = 0; t < workers; t++) {
+            size_t target = (alpha.rowPtr[size] + size) * t / workers;
+            while (i < size && alpha.rowPtr[i] + i < target) i++;
+            bounds[t] = i;
+        }
+        unique_ptr<double[]> buffers[2] = {unique_ptr<double[]>(new double[size]), unique_ptr<double[]>(new double[size])};
+        vector<double> shares[2] = {vector<double>(workers), vector<double>(workers)};
+        SweepBarrier barrier(workers);
+        int last = 0; // buffer holding x~
+
+        auto worker = [&](int t) {
+            int first = bounds[t], end = bounds[t + 1];
+            for (int i = first; i < end; i++) {
+                buffers[0][i] = beta[i];
+                buffers[1][i] = 0;
+            }
+            barrier.wait();
+            for (int k = 0; ; k++) {
+                const double* x1 = buffers[k % 2].get();
+                double* x2 = buffers[(k + 1) % 2].get();
+                alpha.multiply(x1, x2, first, end);
+                double change = 0;
+                for (int i = first; i < end; i++) {
+                    x2[i] += beta[i];
+                    change += pow(x2[i] - x1[i], 2);
+                }
+                shares[k % 2][t] = change;
+                barrier.wait();
+                double ex = 0;
+                for (double share : shares[k % 2]) ex += share;
+                ex = sqrt(ex);
+                if (t == 0) {
+                    stdoutWriter() << "e: " << Fixed{ex, 4} << '\n';
+                    last = (k + 1) % 2;
+                }
+                if (!(ex > e)) return;
+            }
+        };
+        vector<thread> pool;
+        for (int t = 1; t < workers; t++) pool.emplace_back(worker, t);
+        worker(0);
+        for (thread& t : pool) t.join();
+
+        stdoutWriter() << "x~:" << '\n';
+        ColumnVector Answer(size);
+        Answer.vectorArr.assign(buffers[last].get(), buffers[last].get() + size);
         Answer.outputVector();
     }
 };
 
-int main()
+int ColumnVector::threads = max(1, (int)thread::hardware_concurrency());
+
+int main(int argc, char* argv[])
 {
+    if (getenv("MATRIX_THREADS"))
+    {
+        ColumnVector::threads = max(1, atoi(getenv("MATRIX_THREADS")));
+    }
+
+    // jacobi_solver --sparse: "n nnz", nnz "i j a_ij" triplets (1-based),
+    // then b and e as usual
+    if (argc > 1 && strcmp(argv[1], "--sparse") == 0)
+    {
+        int n;
+        size_t nnz;
+        stdinReader() >> n >> nnz;
+        SparseMatrix A = SparseMatrix::input(n, nnz);
+        int m;
+        stdinReader() >> m;
+        if (m != n)
+        {
+            stdoutWriter() << "Error: the dimensional problem occurred" << '\n';
+            return 0;
+        }
+        ColumnVector b(m);
+        b.input();
+        double e;
+        stdinReader() >> e;
+        b.SparseJacobiMethod(A, e);
+        return 0;
+    }
+
     int n;
-    cin >> n;
+    stdinReader() >> n;
     Matrix A(n);
     A.input();
     int m;
-    cin >> m;
+    stdinReader() >> m;
     ColumnVector b(m);
     b.input();
     double e;
-    cin >> e;
+    stdinReader() >> e;
     b.JacobiMethod(A, e);
     return 0;
 }
@@ -7,95 +7,55 @@ and vector under the section “Gaussian process:”,
 followed by diagonal normalization in “Diagonal normalization:” 
 and the final solution in “[Result:](Result:)”. 
 If the matrix is singular, it prints “Error: matrix A is singular.”
+With --no-steps only the results are printed, solved from one LU factorization;
+`--no-steps A.bin B.bin` takes A and the right-hand sides from binary matrix files.
 */
 
-#include <iostream>
 #include <vector>
-#include <iomanip>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <cstring>
+
+#include "matrix_io.h"
+#include "matrix_lu.h"
+#include "matrix_file.h"
 
 using namespace std;
+
 class Matrix
 {
 public:
     int n;
-    vector<vector<double>> array;
+    DenseStorage<double> array;
     Matrix(int n)
     {
         this->n = n;
-        this->array = vector<vector<double>>(n, vector<double>(n));
+        this->array = DenseStorage<double>(n, n);
     }
 
     virtual void input()
     {
-        for (int i = 0; i < n; i++)
-        {
-            for (int j = 0; j < n; j++)
-            {
-                cin >> array[i][j];
-            }
-        }
+        stdinReader().readBlock(array.getData(), n, n, array.getStride());
     }
 
-    void output(vector<double> tempArr)
+    void output(const vector<double>& tempArr)
     {
         for (int i = 0; i < n; i++)
         {
             for (int j = 0; j < n - 1; j++)
             {
-                cout << fixed << setprecision(2) << array[i][j] << " ";
+                stdoutWriter() << Fixed{array[i][j], 2} << " ";
             }
-            cout << fixed << setprecision(2) << array[i][n - 1];
-            cout << '\n';
+            stdoutWriter() << Fixed{array[i][n - 1], 2};
+            stdoutWriter() << '\n';
         }
         for (int j = 0; j < n - 1; j++)
         {
-            cout << fixed << setprecision(2) << tempArr[j] << " ";
-        }
-        cout << fixed << setprecision(2) << tempArr[n - 1];
-        cout << '\n';
-    }
-
-    void makePermutation1(int q, int w)
-    {
-        if (q != w)
-        {
-            swap(array[q], array[w]);
-        }
-    }
-
-    void makeElimination1(int col)
-    {
-        for (int i = col+1; i < n; i++) // walk through the rows
-        {
-            double k = array[i][col] / array[col][col];
-            if (array[i][col] != 0)
-            {
-                for (int j = 0; j < n; j++)
-                {
-                    array[i][j] -= k * array[col][j];
-                }
-            }
-        }
-    }
-
-    void upperTriangular()
-    {
-        int column = 0;
-        for (int count = 0; count < n; count++) { // counter for column detection
-            double mx = 0;
-            int temp = 0;
-            for (int i = count; i < n; i++) {
-                if (abs(array[i][column]) > mx) {
-                    mx = abs(array[i][column]);
-                    temp = i;
-                }
-            }
-            column += 1;
-            if (temp > 0 && abs(mx) != abs(array[count][count])) {
-                makePermutation1(temp, count);
-            }
-            makeElimination1(count);
+            stdoutWriter() << Fixed{tempArr[j], 2} << " ";
         }
+        stdoutWriter() << Fixed{tempArr[n - 1], 2};
+        stdoutWriter() << '\n';
     }
 
     vector<double> makePermutation(int q, int w, vector<double> tempArr)
@@ -103,7 +63,7 @@ public:
         if (q != w)
         {
             swap(tempArr[q], tempArr[w]);
-            swap(array[q], array[w]);
+            array.swapRows(q, w);
         }
         return tempArr;
     }
@@ -124,7 +84,7 @@ public:
                         array[i][j] -= k * array[col][j];
                     }
                     tempArr[i] -= k * tempArr[col];
-                    cout << "step #" << step << ": elimination" << endl;
+                    stdoutWriter() << "step #" << step << ": elimination" << '\n';
                     output(tempArr);
                     step++;
                 }
@@ -138,7 +98,7 @@ public:
                         array[g][j] -= k * array[col][j];
                     }
                     tempArr[g] -= k * tempArr[col];
-                    cout << "step #" << step << ": elimination" << endl;
+                    stdoutWriter() << "step #" << step << ": elimination" << '\n';
                     output(tempArr);
                     step++;
                 }
@@ -154,42 +114,29 @@ public:
         for (int count = 0; count < n; count++) { // counter for column detection
             double mx = 0;
             int temp = 0;
+            ColumnView<double> pivotColumn = array.column(column);
             for (int i = count; i < n; i++) {
-                if (abs(array[i][column]) > mx) {
-                    mx = abs(array[i][column]);
+                if (abs(pivotColumn[i]) > mx) {
+                    mx = abs(pivotColumn[i]);
                     temp = i;
                 }
             }
             column += 1;
             if (temp > 0 && abs(mx) != abs(array[count][count])) {
-                tempArray = makePermutation(temp, count, tempArray);
-                cout << "step #" << step << ": permutation" << endl;
+                tempArray = makePermutation(temp, count, std::move(tempArray));
+                stdoutWriter() << "step #" << step << ": permutation" << '\n';
                 output(tempArray);
                 step++;
             }
-            tempArray = makeElimination(count, tempArray, true);
+            tempArray = makeElimination(count, std::move(tempArray), true);
         }
         // reversed
         for (int count = n - 1; count > 0; count--) { // counter for column detection
-            tempArray = makeElimination(count, tempArray, false);
+            tempArray = makeElimination(count, std::move(tempArray), false);
         }
         return tempArray;
     }
 
-    void findDeterminant()
-    {
-        double det = 1;
-        for (int i = 0; i < n; i++)
-        {
-            det *= array[i][i];
-        }
-        if (det == 0)
-        {
-            cout << "Error: matrix A is singular";
-            exit(0);
-        }
-    }
-
     vector<double> diagonalNormalization(vector<double> tempArray)
     {
         for (int i = 0; i < n; i++)
@@ -207,15 +154,26 @@ public:
                 tempArray[i] = tempArray[i] / k;
             }
         }
-        cout << "Diagonal normalization:" << endl;
+        stdoutWriter() << "Diagonal normalization:" << '\n';
         output(tempArray);
         return tempArray;
     }
 
-    void operator=(const Matrix& ma)
+    Matrix(const Matrix& ma) = default;
+    Matrix(Matrix&& ma) = default;
+
+    Matrix& operator=(const Matrix& ma)
     {
         array = ma.array;
         n = ma.n;
+        return *this;
+    }
+
+    Matrix& operator=(Matrix&& ma)
+    {
+        array = std::move(ma.array);
+        n = ma.n;
+        return *this;
     }
 };
 
@@ -237,20 +195,18 @@ class ColumnVector : public Matrix
 private:
     vector<double> vectorArr;
 public:
-    ColumnVector(int n) : Matrix(n)
+    ColumnVector(int n) : Matrix(0)
     {
+        this->n = n;
         this->vectorArr = ::vector<double>(n);
     }
 
     void input() override
     {
-        for (int i = 0; i < n; i++)
-        {
-            cin >> vectorArr[i];
-        }
+        stdinReader().readBlock(vectorArr.data(), 1, n, n);
     }
 
-    vector<double> getArrayVector()
+    const vector<double>& getArrayVector() const
     {
         return vectorArr;
     }
@@ -264,33 +220,95 @@ public:
     {
         for (int j = 0; j < n - 1; j++)
         {
-            cout << fixed << setprecision(2) << vectorArr[j] << " ";
+            stdoutWriter() << Fixed{vectorArr[j], 2} << " ";
         }
-        cout << fixed << setprecision(2) << vectorArr[n - 1];
-        cout << '\n';
+        stdoutWriter() << Fixed{vectorArr[n - 1], 2};
+        stdoutWriter() << '\n';
     }
 };
 
-int main()
+int main(int argc, char* argv[])
 {
+    if (getenv("MATRIX_THREADS"))
+    {
+        LUFactorization::threads = max(1, atoi(getenv("MATRIX_THREADS")));
+    }
+    if (getenv("MATRIX_SINGULAR_TOLERANCE"))
+    {
+        LUFactorization::tolerance = atof(getenv("MATRIX_SINGULAR_TOLERANCE"));
+    }
+    // linear_system_solver --no-steps A.bin B.bin: A and the right-hand sides,
+    // the columns of B, come from binary matrix files and are all solved
+    // with one factorization
+    if (argc > 3 && strcmp(argv[1], "--no-steps") == 0)
+    {
+        DenseStorage<double> a = readMatrixFile<double>(argv[2]);
+        DenseStorage<double> b = readMatrixFile<double>(argv[3]);
+        int n = a.getRows();
+        if (a.getCols() != n || b.getRows() != n)
+        {
+            stdoutWriter() << "Error: the dimensional problem occurred";
+            return 0;
+        }
+        LUFactorization lu(a);
+        if (lu.isSingular() || lu.determinant() == 0)
+        {
+            stdoutWriter() << "Error: matrix A is singular";
+            return 0;
+        }
+        DenseStorage<double> x = lu.solve(b);
+        for (int c = 0; c < x.getCols(); c++)
+        {
+            ColumnVector result(n);
+            vector<double> column(n);
+            for (int i = 0; i < n; i++) column[i] = x[i][c];
+            result.setArrayVector(column);
+            stdoutWriter() << "Result:" << '\n';
+            result.outputVector();
+        }
+        return 0;
+    }
+
     int n1, n2;
-    cin >> n1;
+    stdinReader() >> n1;
     Matrix A(n1); // matrix A
     A.input();
-    cin >> n2;
+    stdinReader() >> n2;
 
     ColumnVector vector(n2);
     vector.input();
 
-    Matrix TempMatrix(n1);
-    TempMatrix = A;
-    TempMatrix.upperTriangular();
-    TempMatrix.findDeterminant();
+    // one factorization both rejects a singular A and solves every
+    // right-hand side that is not traced
+    LUFactorization lu(A.array);
+    if (lu.isSingular() || lu.determinant() == 0)
+    {
+        stdoutWriter() << "Error: matrix A is singular";
+        return 0;
+    }
 
-    cout << "Gaussian process:" << endl;
-    vector.setArrayVector(A.diagonalNormalization(A.GaussianProcess(vector.getArrayVector())));
+    // linear_system_solver --no-steps: only the results, straight from the factorization
+    bool steps = !(argc > 1 && strcmp(argv[1], "--no-steps") == 0);
+    if (steps)
+    {
+        stdoutWriter() << "Gaussian process:" << '\n';
+        vector.setArrayVector(A.diagonalNormalization(A.GaussianProcess(vector.getArrayVector())));
+    } else
+    {
+        vector.setArrayVector(lu.solve(vector.getArrayVector()));
+    }
 
-    cout << "Result:" << endl;
+    stdoutWriter() << "Result:" << '\n';
     vector.outputVector();
+
+    // further right-hand sides after b
+    while (stdinReader().hasMore())
+    {
+        ColumnVector next(n1);
+        next.input();
+        next.setArrayVector(lu.solve(next.getArrayVector()));
+        stdoutWriter() << "Result:" << '\n';
+        next.outputVector();
+    }
     return 0;
 }
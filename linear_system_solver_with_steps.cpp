@@ -7,25 +7,34 @@ A `ColumnVector` class represents the free vector (b) with input/output and sett
 The program prints each elimination or permutation step with the updated matrix and vector, 
 performs diagonal normalization, and outputs the final solution. 
 If the matrix is singular, it prints an error message.
+With --no-steps it prints only x~, solving the normal equations by Cholesky;
+with --qr it gets x~ from a blocked Householder QR of A instead, and
+with --stream it keeps updating the fit as (x, y) samples arrive.
 */
 
-#include <iostream>
 #include <utility>
 #include <vector>
-#include <iomanip>
 #include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "matrix_io.h"
+#include "matrix_augmented.h"
 
 using namespace std;
+
 class Matrix
 {
 public:
     int n;
     int m;
-    vector<vector<double>> array;
+    DenseStorage<double> array;
     Matrix(int n)
     {
         this->n = n;
-        this->array = vector<vector<double>>(n, vector<double>(n));
+        this->array = DenseStorage<double>(n, n);
 
         // filling the vector with "empty" values (NaN)
         for (int i = 0; i < n; i++)
@@ -58,8 +67,8 @@ public:
         vector<double> vector = ::vector<double>(n, 0);
         for (int i = 0; i < n; i++)
         {
-            cin >> array[i][1];
-            cin >> vector[i];
+            stdinReader() >> array[i][1];
+            stdinReader() >> vector[i];
         }
         return vector;
     }
@@ -80,21 +89,10 @@ public:
         }
     }
 
-    void transposed()
+    // zero-copy A^T of the n x m matrix
+    TransposedView<double> transposedView() const
     {
-        vector<vector<double>> temp = vector<vector<double>>(m, vector<double>(n));
-        for (int i = 0; i < n; i++)
-        {
-            for (int j = 0; j < m; j++)
-            {
-                temp[j][i] = array[i][j];
-            }
-        }
-        this->array = vector<vector<double>>(m, vector<double>(n));
-        int t = m;
-        this->m = n;
-        this->n = t;
-        this->array = std::move(temp);
+        return {array.getData(), m, n, array.getStride()};
     }
 
     void output()
@@ -105,21 +103,21 @@ public:
             {
                 if (!isnan(this->array[i][j]))
                 {
-                    cout << fixed << setprecision(4) << array[i][j] << " ";
+                    stdoutWriter() << Fixed{array[i][j], 4} << " ";
                 }
             }
             if (!isnan(this->array[i][m - 1]))
             {
-                cout << fixed << setprecision(4) << array[i][m - 1];
+                stdoutWriter() << Fixed{array[i][m - 1], 4};
             }
-            cout << '\n';
+            stdoutWriter() << '\n';
         }
     }
 
     void clear()
     {
         int m1 = 0;
-        vector<vector<double>> new_array = vector<vector<double>>(n, vector<double>(n));
+        DenseStorage<double> new_array = DenseStorage<double>(n, n);
         for (int i = 0; i < n; i++)
         {
             for (int j = 0; j < m; j++)
@@ -134,116 +132,337 @@ public:
         this->array = std::move(new_array);
     }
 
-    vector<vector<double>> multiplication(int n2, int m2, vector<vector<double>> arr2)
+    void setArray(DenseStorage<double> t)
+    {
+        array = std::move(t);
+    }
+
+    DenseStorage<double>& getArray()
+    {
+        return array;
+    }
+
+    const DenseStorage<double>& getArray() const
+    {
+        return array;
+    }
+
+};
+
+// t * t^T (SYRK) for a view t = A^T, i.e. A^T * A accumulated one row of A
+// at a time: the product is symmetric, so only the upper triangle is
+// computed and then mirrored
+DenseStorage<double> multiplicationByTransposed(const TransposedView<double>& t)
+{
+    int n = t.rows;
+    DenseStorage<double> temp = DenseStorage<double>(n, n, 0);
+    for (int c = 0; c < t.cols; c++)
     {
-        vector<vector<double>> temp = vector<vector<double>>(n, vector<double>(m2, 0));
         for (int i = 0; i < n; i++)
         {
-            for (int j = 0; j < m2; j++)
+            double ti = t(i, c);
+            double* rowI = temp[i];
+            for (int j = i; j < n; j++)
             {
-                for (int c = 0; c < m; c++)
-                {
-                    temp[i][j] += array[i][c] * arr2[c][j];
-                }
+                rowI[j] += ti * t(j, c);
             }
         }
-        return temp;
     }
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = i + 1; j < n; j++)
+        {
+            temp[j][i] = temp[i][j];
+        }
+    }
+    return temp;
+}
 
-    void setArray(vector<vector<double>> t)
+// Cholesky factorization A = L * L^T of a symmetric positive definite
+// matrix; only the lower triangle of A is read. Half the work of LU and no
+// pivoting, and a right-hand side then costs two triangular solves.
+class CholeskyFactorization
+{
+private:
+    int n;
+    DenseStorage<double> l;
+    bool positiveDefinite;
+public:
+    // a is a Gram matrix whose entries are sums of `terms` products; a pivot
+    // at or below eps * max(a_jj) * terms is rounding noise and counts as
+    // singular, as in HouseholderQR's rank test
+    CholeskyFactorization(const DenseStorage<double>& a, int terms)
+        : n(a.getRows()), l(a.getRows(), a.getRows()), positiveDefinite(true)
     {
-        array = std::move(t);
+        double largest = 0;
+        for (int j = 0; j < n; j++) largest = max(largest, a[j][j]);
+        double threshold = numeric_limits<double>::epsilon() * largest * terms;
+        for (int j = 0; j < n; j++)
+        {
+            const double* rowJ = l[j];
+            double d = a[j][j];
+            for (int p = 0; p < j; p++) d -= rowJ[p] * rowJ[p];
+            if (!(d > threshold))
+            {
+                positiveDefinite = false;
+                return;
+            }
+            double diagonal = sqrt(d);
+            l[j][j] = diagonal;
+            for (int i = j + 1; i < n; i++)
+            {
+                const double* rowI = l[i];
+                double sum = a[i][j];
+                for (int p = 0; p < j; p++) sum -= rowI[p] * rowJ[p];
+                l[i][j] = sum / diagonal;
+            }
+        }
     }
 
-    vector<vector<double>> getArray()
+    bool isPositiveDefinite() const
     {
-        return array;
+        return positiveDefinite;
     }
 
-    vector<vector<double>> makePermutation(int q, int w, vector<vector<double>> tempArr)
+    // L * y = b, then L^T * x = y
+    vector<double> solve(const vector<double>& b) const
     {
-        if (q != w)
+        vector<double> x(b);
+        for (int i = 0; i < n; i++)
+        {
+            const double* rowI = l[i];
+            for (int p = 0; p < i; p++) x[i] -= rowI[p] * x[p];
+            x[i] /= rowI[i];
+        }
+        for (int i = n - 1; i >= 0; i--)
         {
-            swap(tempArr[q], tempArr[w]);
-            swap(array[q], array[w]);
+            for (int p = i + 1; p < n; p++) x[i] -= l[p][i] * x[p];
+            x[i] /= l[i][i];
         }
-        return tempArr;
+        return x;
     }
+};
 
-    vector<vector<double>> makeElimination(int col, vector<vector<double>> tempArr, bool flag)
+// Householder QR of a tall m x n matrix (m >= n), A = Q * R, without ever
+// forming A^T*A. Columns are processed in QR_BLOCK-wide panels: a panel is
+// reduced one reflector at a time, then its reflectors are combined into
+// the compact WY form H_1 ... H_kb = I - V * T * V^T and the trailing
+// columns are updated with matrix-matrix products.
+class HouseholderQR
+{
+private:
+    int m, n;
+    DenseStorage<double> qr; // R on and above the diagonal, v below it (v_kk = 1)
+    vector<double> tau;
+    vector<DenseStorage<double>> t; // T factor of each panel
+    bool fullRank;
+    static constexpr int QR_BLOCK = 32;
+
+    // reflector of column k over rows k..m-1, applied to columns k+1..end-1
+    void reflect(int k, int end)
     {
-        if (flag)
+        double alpha = qr[k][k], sigma = 0;
+        for (int i = k + 1; i < m; i++) sigma += qr[i][k] * qr[i][k];
+        if (sigma == 0)
+        {
+            tau[k] = 0;
+            return;
+        }
+        double beta = -copysign(sqrt(alpha * alpha + sigma), alpha);
+        tau[k] = (beta - alpha) / beta;
+        for (int i = k + 1; i < m; i++) qr[i][k] /= alpha - beta;
+        qr[k][k] = beta;
+        for (int j = k + 1; j < end; j++)
         {
-            for (int i = col+1; i < n; i++) // walk through the rows
+            double w = qr[k][j];
+            for (int i = k + 1; i < m; i++) w += qr[i][k] * qr[i][j];
+            w *= tau[k];
+            qr[k][j] -= w;
+            for (int i = k + 1; i < m; i++) qr[i][j] -= w * qr[i][k];
+        }
+    }
+
+    // element (r, j) of the panel's V, including the implicit unit diagonal
+    double v(int r, int k) const
+    {
+        return r == k ? 1 : (r > k ? qr[r][k] : 0);
+    }
+
+    // C := (I - V T V^T)^T C for the panel at k0, on columns c0..c0+nc-1 of c
+    void applyPanel(int k0, int kb, DenseStorage<double>& c, int c0, int nc) const
+    {
+        const DenseStorage<double>& tk = t[k0 / QR_BLOCK];
+        DenseStorage<double> w(kb, nc);
+        // W = V^T C
+        for (int r = k0; r < m; r++)
+        {
+            const double* rowC = c[r] + c0;
+            for (int p = 0; p < kb && k0 + p <= r; p++)
             {
-                double k = array[i][col] / array[col][col];
-                if (array[i][col] != 0)
-                {
-                    for (int j = 0; j < n; j++)
-                    {
-                        tempArr[i][j] -= k * tempArr[col][j];
-                        array[i][j] -= k * array[col][j];
-                    }
-                    step++;
-                }
+                double vr = v(r, k0 + p);
+                double* rowW = w[p];
+                for (int j = 0; j < nc; j++) rowW[j] += vr * rowC[j];
             }
-        } else {
-            for (int g = col - 1; g >= 0; g--) // walk through the rows
+        }
+        // W = T^T W, bottom row first since T is upper triangular
+        for (int p = kb - 1; p >= 0; p--)
+        {
+            double* rowW = w[p];
+            for (int j = 0; j < nc; j++) rowW[j] *= tk[p][p];
+            for (int q = 0; q < p; q++)
             {
-                double k = array[g][col] / array[col][col];
-                if (array[g][col] != 0) {
-                    for (int j = n - 1; j >= 0; j--) {
-                        tempArr[g][j] -= k * tempArr[col][j];
-                        array[g][j] -= k * array[col][j];
-                    }
-                    step++;
-                }
+                const double* rowQ = w[q];
+                for (int j = 0; j < nc; j++) rowW[j] += tk[q][p] * rowQ[j];
+            }
+        }
+        // C -= V W
+        for (int r = k0; r < m; r++)
+        {
+            double* rowC = c[r] + c0;
+            for (int p = 0; p < kb && k0 + p <= r; p++)
+            {
+                double vr = v(r, k0 + p);
+                const double* rowW = w[p];
+                for (int j = 0; j < nc; j++) rowC[j] -= vr * rowW[j];
             }
         }
-        return tempArr;
     }
-
-    // array[i][j] - k * array[i-1][j]
-    // array[i][j] - k * array[i-1][j] = 0 => k = array[i][j] / array[i-1][j]
-    int step = 1;
-    vector<vector<double>> GaussianProcess(vector<vector<double>> tempArray)
+public:
+    explicit HouseholderQR(const DenseStorage<double>& a)
+        : m(a.getRows()), n(a.getCols()), qr(a), tau(n), fullRank(m >= n)
     {
-        int column = 0;
-        for (int count = 0; count < n; count++) { // counter for column detection
-            double mx = 0;
-            int temp = 0;
-            for (int i = count; i < n; i++) {
-                if (abs(array[i][column]) > mx) {
-                    mx = abs(array[i][column]);
-                    temp = i;
+        // fewer rows than columns: there are not n reflectors to build
+        if (!fullRank) return;
+        for (int k0 = 0; k0 < n; k0 += QR_BLOCK)
+        {
+            int kb = min(QR_BLOCK, n - k0);
+            for (int k = k0; k < k0 + kb; k++) reflect(k, k0 + kb);
+            // T_ii = tau_i, T[0:i, i] = -tau_i * T[0:i, 0:i] * (V[:, 0:i]^T v_i)
+            DenseStorage<double> tk(kb, kb);
+            for (int i = 0; i < kb; i++)
+            {
+                vector<double> z(i);
+                for (int p = 0; p < i; p++)
+                {
+                    for (int r = k0 + i; r < m; r++) z[p] += v(r, k0 + p) * v(r, k0 + i);
                 }
+                for (int p = 0; p < i; p++)
+                {
+                    double sum = 0;
+                    for (int q = p; q < i; q++) sum += tk[p][q] * z[q];
+                    tk[p][i] = -tau[k0 + i] * sum;
+                }
+                tk[i][i] = tau[k0 + i];
             }
-            column += 1;
-            if (temp > 0 && abs(mx) != abs(array[count][count])) {
-                tempArray = makePermutation(temp, count, tempArray);
-                step++;
-            }
-            tempArray = makeElimination(count, tempArray, true);
+            t.push_back(std::move(tk));
+            if (k0 + kb < n) applyPanel(k0, kb, qr, k0 + kb, n - k0 - kb);
         }
-        // reversed
-        for (int count = n - 1; count > 0; count--) { // counter for column detection
-            tempArray = makeElimination(count, tempArray, false);
+        // rank deficient when some |R_kk| is at rounding level next to the
+        // largest diagonal entry of R
+        double largest = 0;
+        for (int k = 0; k < n; k++) largest = max(largest, abs(qr[k][k]));
+        double threshold = numeric_limits<double>::epsilon() * largest * m;
+        for (int k = 0; k < n; k++)
+        {
+            if (abs(qr[k][k]) <= threshold) fullRank = false;
         }
-        return tempArray;
     }
 
-    vector<vector<double>> diagonalNormalization(vector<vector<double>> tempArray)
+    bool isFullRank() const
     {
-        for (int i = 0; i < n; i++)
+        return fullRank;
+    }
+
+    // x minimizing ||A x - b||: R x = (Q^T b)[0..n)
+    vector<double> solve(const vector<double>& b) const
+    {
+        DenseStorage<double> y(m, 1);
+        for (int i = 0; i < m; i++) y[i][0] = b[i];
+        for (int k0 = 0; k0 < n; k0 += QR_BLOCK)
         {
-            double k = array[i][i];
-            for (int j = 0; j < n; j++)
+            applyPanel(k0, min(QR_BLOCK, n - k0), y, 0, 1);
+        }
+        vector<double> x(n);
+        for (int i = n - 1; i >= 0; i--)
+        {
+            double sum = y[i][0];
+            for (int j = i + 1; j < n; j++) sum -= qr[i][j] * x[j];
+            x[i] = sum / qr[i][i];
+        }
+        return x;
+    }
+};
+
+// Least-squares fit of a degree-n polynomial to samples that arrive one at
+// a time. Only the n+1 x n+1 triangular factor R of the samples seen so far
+// and Q^T y are kept; a new sample row is rotated into R with Givens
+// rotations, so each update is O(n^2) and memory stays constant.
+class OnlineLeastSquares
+{
+private:
+    int n;
+    DenseStorage<double> r;
+    vector<double> qty;
+    vector<double> row;
+    long long samples;
+public:
+    explicit OnlineLeastSquares(int degree)
+        : n(degree + 1), r(degree + 1, degree + 1), qty(degree + 1), row(degree + 1), samples(0)
+    {
+    }
+
+    void add(double x, double y)
+    {
+        samples++;
+        double power = 1;
+        for (int j = 0; j < n; j++)
+        {
+            row[j] = power;
+            power *= x;
+        }
+        for (int k = 0; k < n; k++)
+        {
+            if (row[k] == 0) continue;
+            double* rowK = r[k];
+            double h = hypot(rowK[k], row[k]);
+            double c = rowK[k] / h, s = row[k] / h;
+            for (int j = k; j < n; j++)
             {
-                array[i][j] /= k;
-                tempArray[i][j] /= k;
+                double u = rowK[j], v = row[j];
+                rowK[j] = c * u + s * v;
+                row[j] = c * v - s * u;
             }
+            double u = qty[k];
+            qty[k] = c * u + s * y;
+            y = c * y - s * u;
         }
-        return tempArray;
+    }
+
+    // false until the samples determine every coefficient: an |R_kk| at
+    // rounding level next to the largest diagonal entry counts as zero
+    bool isDetermined() const
+    {
+        double largest = 0;
+        for (int k = 0; k < n; k++) largest = max(largest, abs(r[k][k]));
+        double threshold = numeric_limits<double>::epsilon() * largest * samples;
+        for (int k = 0; k < n; k++)
+        {
+            if (abs(r[k][k]) <= threshold) return false;
+        }
+        return true;
+    }
+
+    // current coefficients, R x = Q^T y
+    vector<double> coefficients() const
+    {
+        vector<double> x(n);
+        for (int i = n - 1; i >= 0; i--)
+        {
+            double sum = qty[i];
+            for (int j = i + 1; j < n; j++) sum -= r[i][j] * x[j];
+            x[i] = sum / r[i][i];
+        }
+        return x;
     }
 };
 
@@ -253,9 +472,9 @@ public:
     IdentityMatrix(int n) : Matrix(n)
     {
         this->n = n;
-        this->array = vector<vector<double>>(n, vector<double>(n, 0));
+        this->array = DenseStorage<double>(n, n, 0);
     }
-    vector<vector<double>> change()
+    DenseStorage<double>& change()
     {
         for (int i = 0; i < n; i++)
         {
@@ -270,17 +489,15 @@ class ColumnVector : public Matrix
 private:
     vector<double> vectorArr;
 public:
-    ColumnVector(int n) : Matrix(n)
+    ColumnVector(int n) : Matrix(0)
     {
+        this->n = n;
         this->vectorArr = ::vector<double>(n);
     }
 
     void input()
     {
-        for (int i = 0; i < n; i++)
-        {
-            cin >> vectorArr[i];
-        }
+        stdinReader().readBlock(vectorArr.data(), 1, n, n);
     }
 
     void setArrayVector(vector<double> t)
@@ -288,14 +505,19 @@ public:
         vectorArr = std::move(t);
     }
 
+    const vector<double>& getArrayVector() const
+    {
+        return vectorArr;
+    }
+
     void outputVector()
     {
         for (int j = 0; j < n - 1; j++)
         {
-            cout << fixed << setprecision(4) << vectorArr[j] << endl;
+            stdoutWriter() << Fixed{vectorArr[j], 4} << '\n';
         }
-        cout << fixed << setprecision(4) << vectorArr[n - 1];
-        cout << '\n';
+        stdoutWriter() << Fixed{vectorArr[n - 1], 4};
+        stdoutWriter() << '\n';
     }
 
     void clearVector()
@@ -313,7 +535,7 @@ public:
         this->vectorArr = std::move(new_vector);
     }
 
-    vector<double> vectorMultiplication(int n2, int m2, vector<vector<double>> arr2)
+    vector<double> vectorMultiplication(int n2, int m2, const DenseStorage<double>& arr2)
     {
         vector<double> tempVector = vector<double>(n2, 0);
         for (int i = 0; i < n2; i++)
@@ -325,18 +547,120 @@ public:
         }
         return tempVector;
     }
+
+    // t * this for a view t = A^T, walking A row by row
+    vector<double> vectorMultiplication(const TransposedView<double>& t)
+    {
+        vector<double> tempVector = vector<double>(t.rows, 0);
+        for (int j = 0; j < t.cols; j++)
+        {
+            for (int i = 0; i < t.rows; i++)
+            {
+                tempVector[i] += vectorArr[j] * t(i, j);
+            }
+        }
+        return tempVector;
+    }
 };
 
-int main()
+int main(int argc, char* argv[])
 {
+    // linear_system_solver_with_steps --stream <degree> [every]: reads "x y"
+    // samples until the end of input and prints x~ after every `every`
+    // samples (default: once, at the end)
+    if (argc > 2 && strcmp(argv[1], "--stream") == 0)
+    {
+        int degree = atoi(argv[2]);
+        long long every = argc > 3 ? atoll(argv[3]) : 0;
+        OnlineLeastSquares fit(degree);
+        long long samples = 0;
+        while (stdinReader().hasMore())
+        {
+            double x, y;
+            stdinReader() >> x >> y;
+            fit.add(x, y);
+            samples++;
+            bool query = every > 0 ? samples % every == 0 : !stdinReader().hasMore();
+            if (!query) continue;
+            if (!fit.isDetermined())
+            {
+                stdoutWriter() << "Error: matrix A is rank deficient" << '\n';
+                continue;
+            }
+            ColumnVector Answer(degree + 1);
+            Answer.setArrayVector(fit.coefficients());
+            stdoutWriter() << "x~:" << '\n';
+            Answer.outputVector();
+        }
+        return 0;
+    }
+
     int m, n;
-    cin >> m;
+    stdinReader() >> m;
     Matrix matrix(m);
     ColumnVector Vector_b(m);
     Vector_b.setArrayVector(matrix.inputArrayVector());
-    cin >> n;
+    stdinReader() >> n;
+    bool noSteps = argc > 1 && strcmp(argv[1], "--no-steps") == 0;
+    bool useQR = argc > 1 && strcmp(argv[1], "--qr") == 0;
+    // fewer samples than coefficients: A_T*A is singular, and A would not
+    // even have room for the n + 1 columns
+    if (noSteps && m < n + 1)
+    {
+        stdoutWriter() << "Error: matrix A_T*A is singular";
+        return 0;
+    }
+    if (useQR && m < n + 1)
+    {
+        stdoutWriter() << "Error: matrix A is rank deficient";
+        return 0;
+    }
     matrix.fillingInTheCells(n);
-    cout << "A:" << endl;
+
+    // linear_system_solver_with_steps --no-steps: only x~, from A_T*A formed
+    // by SYRK and solved by Cholesky, without building the inverse
+    if (noSteps)
+    {
+        matrix.clear();
+        TransposedView<double> A_T = matrix.transposedView();
+        CholeskyFactorization cholesky(multiplicationByTransposed(A_T), m);
+        if (!cholesky.isPositiveDefinite())
+        {
+            stdoutWriter() << "Error: matrix A_T*A is singular";
+            return 0;
+        }
+        Vector_b.clearVector();
+        ColumnVector Answer(n + 1);
+        Answer.setArrayVector(cholesky.solve(Vector_b.vectorMultiplication(A_T)));
+        stdoutWriter() << "x~:" << '\n';
+        Answer.outputVector();
+        return 0;
+    }
+
+    // linear_system_solver_with_steps --qr: only x~, from a Householder QR of A
+    if (useQR)
+    {
+        matrix.clear();
+        DenseStorage<double> vandermonde(m, n + 1);
+        for (int i = 0; i < m; i++)
+        {
+            copy(matrix.getArray()[i], matrix.getArray()[i] + n + 1, vandermonde[i]);
+        }
+        HouseholderQR qr(vandermonde);
+        if (!qr.isFullRank())
+        {
+            stdoutWriter() << "Error: matrix A is rank deficient";
+            return 0;
+        }
+        Vector_b.clearVector();
+        ColumnVector Answer(n + 1);
+        Answer.setArrayVector(qr.solve(Vector_b.getArrayVector()));
+        stdoutWriter() << "x~:" << '\n';
+        Answer.outputVector();
+        return 0;
+    }
+
+    stdoutWriter() << "A:" << '\n';
     Matrix A(m);
     A.setM(matrix.getM());
     A.setArray(matrix.getArray());
@@ -344,44 +668,38 @@ int main()
     A.clear();
     matrix.clear();
 
-    // transposed
-    Matrix A_T(m);
-    A_T.setM(matrix.getM());
-    A_T.setArray(matrix.getArray());
-    A_T.transposed();
+    // transposed, read in place from the sample matrix
+    TransposedView<double> A_T = matrix.transposedView();
 
     // multiplication
-    cout << "A_T*A:" << endl;
+    stdoutWriter() << "A_T*A:" << '\n';
     n += 1;
     Matrix MatrixA_TA(n);
-    Matrix A_TCopy(n);
-    A_TCopy.setArray(A_T.getArray());
-    A_TCopy.setM(A_T.getM());
     MatrixA_TA.setM(n);
-    MatrixA_TA.setArray(A_T.multiplication(m, n, matrix.getArray()));
+    MatrixA_TA.setArray(multiplicationByTransposed(A_T));
     if (!MatrixA_TA.getArray().empty())
         MatrixA_TA.output();
 
-    cout << "(A_T*A)^-1:" << endl;
+    stdoutWriter() << "(A_T*A)^-1:" << '\n';
     Matrix A_Inv(n);
     IdentityMatrix identityArray(n);
     identityArray.change();
-    vector<vector<double>> tempArr = MatrixA_TA.GaussianProcess(identityArray.getArray()); // start for gaussian process
-    vector<vector<double>> res = MatrixA_TA.diagonalNormalization(tempArr);
-    MatrixA_TA.setArray(res);
-    A_Inv.setArray(MatrixA_TA.getArray());
+    AugmentedMatrix augmented(MatrixA_TA.getArray(), identityArray.getArray(), 2, 0);
+    augmented.GaussianProcess(); // start for gaussian process
+    augmented.diagonalNormalization();
+    A_Inv.setArray(augmented.right());
     A_Inv.setM(MatrixA_TA.getM());
     A_Inv.output();
 
-    cout << "A_T*b:" << endl;
+    stdoutWriter() << "A_T*b:" << '\n';
     Matrix MatrixA_Tb(m);
     MatrixA_Tb.setM(1);
     Vector_b.clearVector();
     ColumnVector Result(n);
-    Result.setArrayVector(Vector_b.vectorMultiplication(n, m, A_TCopy.getArray()));
+    Result.setArrayVector(Vector_b.vectorMultiplication(A_T));
     Result.outputVector();
 
-    cout << "x~:" << endl;
+    stdoutWriter() << "x~:" << '\n';
     ColumnVector Answer(n);
     Answer.setArrayVector(Result.vectorMultiplication(n, n, A_Inv.getArray()));
     Answer.outputVector();
@@ -0,0 +1,170 @@
+/*
+In-place Gauss-Jordan elimination on an augmented [A | B] buffer, shared
+by the programs that invert a matrix through it.
+*/
+
+#ifndef MATRIX_AUGMENTED_H
+#define MATRIX_AUGMENTED_H
+
+#include <algorithm>
+#include <cmath>
+
+#include "matrix_io.h"
+
+// Gauss-Jordan elimination on one n x (n + m) buffer [A | B]. Every row
+// operation is a single in-place pass over the augmented row, so the
+// whole process allocates once and copies nothing; afterwards the right
+// half holds A^-1 * B. The programs differ only in how they report it:
+// output() prints `digits` decimals, and the TRACE_* bits in `trace` pick
+// the steps that are announced, each followed by the whole buffer.
+class AugmentedMatrix
+{
+public:
+    static constexpr int TRACE_PERMUTATIONS = 1;
+    static constexpr int TRACE_ELIMINATIONS = 2;
+    static constexpr int TRACE_NORMALIZATION = 4;
+
+    int n, m;
+    DenseStorage<double> array;
+    int step = 1;
+    int digits;
+    int trace;
+
+    AugmentedMatrix(const DenseStorage<double>& a, const DenseStorage<double>& b, int digits, int trace)
+        : n(a.getRows()), m(b.getCols()), array(a.getRows(), a.getRows() + b.getCols()), digits(digits), trace(trace)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            std::copy(a[i], a[i] + n, array[i]);
+            std::copy(b[i], b[i] + m, array[i] + n);
+        }
+    }
+
+    void output()
+    {
+        for (int i = 0; i < n; i++)
+        {
+            for (int j = 0; j < n + m - 1; j++)
+            {
+                stdoutWriter() << Fixed{array[i][j], digits} << " ";
+            }
+            stdoutWriter() << Fixed{array[i][n + m - 1], digits};
+            stdoutWriter() << '\n';
+        }
+    }
+
+    void makePermutation(int q, int w)
+    {
+        if (q != w)
+        {
+            array.swapRows(q, w);
+        }
+    }
+
+    // array[i][j] - k * array[i-1][j]
+    // array[i][j] - k * array[i-1][j] = 0 => k = array[i][j] / array[i-1][j]
+    void makeElimination(int col, bool flag)
+    {
+        const double* pivotRow = array[col];
+        if (flag)
+        {
+            for (int i = col+1; i < n; i++) // walk through the rows
+            {
+                double k = array[i][col] / pivotRow[col];
+                if (array[i][col] != 0)
+                {
+                    double* row = array[i];
+                    for (int j = 0; j < n + m; j++)
+                    {
+                        row[j] -= k * pivotRow[j];
+                    }
+                    if (trace & TRACE_ELIMINATIONS)
+                    {
+                        stdoutWriter() << "step #" << step << ": elimination" << '\n';
+                        output();
+                    }
+                    step++;
+                }
+            }
+        } else {
+            for (int g = col - 1; g >= 0; g--) // walk through the rows
+            {
+                double k = array[g][col] / pivotRow[col];
+                if (array[g][col] != 0) {
+                    double* row = array[g];
+                    for (int j = 0; j < n + m; j++) {
+                        row[j] -= k * pivotRow[j];
+                    }
+                    if (trace & TRACE_ELIMINATIONS)
+                    {
+                        stdoutWriter() << "step #" << step << ": elimination" << '\n';
+                        output();
+                    }
+                    step++;
+                }
+            }
+        }
+    }
+
+    void GaussianProcess()
+    {
+        int column = 0;
+        for (int count = 0; count < n; count++) { // counter for column detection
+            double mx = 0;
+            int temp = 0;
+            ColumnView<double> pivotColumn = array.column(column);
+            for (int i = count; i < n; i++) {
+                if (std::abs(pivotColumn[i]) > mx) {
+                    mx = std::abs(pivotColumn[i]);
+                    temp = i;
+                }
+            }
+            column += 1;
+            if (temp > 0 && std::abs(mx) != std::abs(array[count][count])) {
+                makePermutation(temp, count);
+                if (trace & TRACE_PERMUTATIONS)
+                {
+                    stdoutWriter() << "step #" << step << ": permutation" << '\n';
+                    output();
+                }
+                step++;
+            }
+            makeElimination(count, true);
+        }
+        // reversed
+        for (int count = n - 1; count > 0; count--) { // counter for column detection
+            makeElimination(count, false);
+        }
+    }
+
+    void diagonalNormalization()
+    {
+        for (int i = 0; i < n; i++)
+        {
+            double k = array[i][i];
+            double* row = array[i];
+            for (int j = 0; j < n + m; j++)
+            {
+                row[j] /= k;
+            }
+        }
+        if (trace & TRACE_NORMALIZATION)
+        {
+            stdoutWriter() << "Diagonal normalization:" << '\n';
+            output();
+        }
+    }
+
+    // B half of the buffer
+    DenseStorage<double> right() const
+    {
+        DenseStorage<double> result(n, m);
+        for (int i = 0; i < n; i++)
+        {
+            std::copy(array[i] + n, array[i] + n + m, result[i]);
+        }
+        return result;
+    }
+};
+
+#endif
@@ -0,0 +1,197 @@
+/*
+Batched small-matrix elimination shared by the --batch modes of the
+determinant and inverse calculators.
+*/
+
+#ifndef MATRIX_BATCH_H
+#define MATRIX_BATCH_H
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+
+const int BATCH_LANES = 64;
+
+// Many small matrices of one size in struct-of-arrays layout: element
+// (i, j) of matrix b is data[(i * cols + j) * count + b]. Work is done on
+// chunks of BATCH_LANES matrices and every elimination step is one loop
+// across the chunk, so the compiler vectorizes over the batch instead of
+// over rows that are only 2..8 long. Chunks are spread over threads.
+class MatrixBatch
+{
+private:
+    // Gaussian elimination of a chunk held as [element][lane]: a is n x n,
+    // rhs is n x m and is overwritten with A^-1 * rhs when `back` is set.
+    // A lower row with a strictly larger |a_ik| is swapped up branchlessly,
+    // which leaves the max-abs pivot on the diagonal. det gets the signed
+    // diagonal product; singular lanes end with det == 0.
+    static void eliminate(int n, double* a, double* rhs, int m, bool back, double* det)
+    {
+        const int W = BATCH_LANES;
+        double sign[W], factor[W];
+        bool up[W];
+        for (int l = 0; l < W; l++) sign[l] = 1;
+        for (int k = 0; k < n; k++)
+        {
+            double* rowK = a + (size_t)k * n * W;
+            double* rhsK = rhs + (size_t)k * m * W;
+            for (int i = k + 1; i < n; i++)
+            {
+                double* rowI = a + (size_t)i * n * W;
+                double* rhsI = rhs + (size_t)i * m * W;
+                for (int l = 0; l < W; l++)
+                {
+                    up[l] = std::abs(rowI[k * W + l]) > std::abs(rowK[k * W + l]);
+                    sign[l] = up[l] ? -sign[l] : sign[l];
+                }
+                for (int c = k; c < n; c++)
+                {
+                    for (int l = 0; l < W; l++)
+                    {
+                        double x = rowK[c * W + l], y = rowI[c * W + l];
+                        rowK[c * W + l] = up[l] ? y : x;
+                        rowI[c * W + l] = up[l] ? x : y;
+                    }
+                }
+                for (int c = 0; c < m; c++)
+                {
+                    for (int l = 0; l < W; l++)
+                    {
+                        double x = rhsK[c * W + l], y = rhsI[c * W + l];
+                        rhsK[c * W + l] = up[l] ? y : x;
+                        rhsI[c * W + l] = up[l] ? x : y;
+                    }
+                }
+            }
+            for (int i = k + 1; i < n; i++)
+            {
+                double* rowI = a + (size_t)i * n * W;
+                double* rhsI = rhs + (size_t)i * m * W;
+                for (int l = 0; l < W; l++)
+                {
+                    double pivot = rowK[k * W + l];
+                    factor[l] = pivot == 0 ? 0 : rowI[k * W + l] / pivot;
+                }
+                for (int c = k + 1; c < n; c++)
+                {
+                    for (int l = 0; l < W; l++) rowI[c * W + l] -= factor[l] * rowK[c * W + l];
+                }
+                for (int c = 0; c < m; c++)
+                {
+                    for (int l = 0; l < W; l++) rhsI[c * W + l] -= factor[l] * rhsK[c * W + l];
+                }
+            }
+        }
+        for (int l = 0; l < W; l++)
+        {
+            det[l] = sign[l];
+            for (int k = 0; k < n; k++) det[l] *= a[((size_t)k * n + k) * W + l];
+        }
+        if (!back) return;
+        for (int i = n - 1; i >= 0; i--)
+        {
+            const double* rowI = a + (size_t)i * n * W;
+            double* rhsI = rhs + (size_t)i * m * W;
+            for (int j = i + 1; j < n; j++)
+            {
+                const double* rhsJ = rhs + (size_t)j * m * W;
+                for (int c = 0; c < m; c++)
+                {
+                    for (int l = 0; l < W; l++) rhsI[c * W + l] -= rowI[j * W + l] * rhsJ[c * W + l];
+                }
+            }
+            for (int c = 0; c < m; c++)
+            {
+                for (int l = 0; l < W; l++) rhsI[c * W + l] /= rowI[i * W + l];
+            }
+        }
+    }
+
+    // runs eliminate over every chunk; rhs == nullptr means the identity
+    void run(const MatrixBatch* rhs, MatrixBatch* x, std::vector<double>& det) const
+    {
+        const int W = BATCH_LANES;
+        int n = rows, m = rhs ? rhs->cols : (x ? n : 0);
+        int chunks = (count + W - 1) / W;
+        std::atomic<int> nextChunk(0);
+        auto worker = [&]()
+        {
+            std::vector<double> a((size_t)n * n * W), b((size_t)n * m * W);
+            double d[W];
+            int chunk;
+            while ((chunk = nextChunk++) < chunks)
+            {
+                int b0 = chunk * W, w = std::min(W, count - b0);
+                // lanes past the end of the batch hold the identity
+                std::fill(a.begin(), a.end(), 0.0);
+                for (int k = 0; k < n; k++) std::fill_n(&a[((size_t)k * n + k) * W + w], W - w, 1.0);
+                for (size_t e = 0; e < (size_t)n * n; e++) std::copy_n(&data[e * count + b0], w, &a[e * W]);
+                std::fill(b.begin(), b.end(), 0.0);
+                for (size_t e = 0; e < (size_t)n * m; e++)
+                {
+                    if (rhs) std::copy_n(&rhs->data[e * count + b0], w, &b[e * W]);
+                    else if (e / m == e % m) std::fill_n(&b[e * W], w, 1.0);
+                }
+                eliminate(n, a.data(), b.data(), m, x != nullptr, d);
+                std::copy_n(d, w, &det[b0]);
+                if (!x) continue;
+                for (size_t e = 0; e < (size_t)n * m; e++) std::copy_n(&b[e * W], w, &x->data[e * count + b0]);
+            }
+        };
+        std::vector<std::thread> pool;
+        int workers = std::max(1, std::min(threads, chunks));
+        for (int id = 1; id < workers; id++) pool.emplace_back(worker);
+        worker();
+        for (std::thread& t : pool) t.join();
+    }
+public:
+    int rows, cols, count;
+    std::vector<double> data;
+
+    // worker threads over chunks; set from MATRIX_THREADS in main()
+    static inline int threads = std::max(1, (int)std::thread::hardware_concurrency());
+
+    MatrixBatch(int rows, int cols, int count)
+        : rows(rows), cols(cols), count(count), data((size_t)rows * cols * count)
+    {
+    }
+
+    double& at(int b, int i, int j)
+    {
+        return data[((size_t)i * cols + j) * count + b];
+    }
+
+    double at(int b, int i, int j) const
+    {
+        return data[((size_t)i * cols + j) * count + b];
+    }
+
+    std::vector<double> determinants() const
+    {
+        std::vector<double> det(count);
+        run(nullptr, nullptr, det);
+        return det;
+    }
+
+    // inverses of all matrices; singular ones come back with det[b] == 0
+    MatrixBatch inverses(std::vector<double>& det) const
+    {
+        MatrixBatch x(rows, rows, count);
+        det.assign(count, 0);
+        run(nullptr, &x, det);
+        return x;
+    }
+
+    // X_b = A_b^-1 * B_b for an n x m right-hand side batch
+    MatrixBatch solve(const MatrixBatch& rhs, std::vector<double>& det) const
+    {
+        MatrixBatch x(rows, rhs.cols, count);
+        det.assign(count, 0);
+        run(&rhs, &x, det);
+        return x;
+    }
+};
+
+#endif
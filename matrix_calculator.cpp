@@ -11,112 +11,229 @@ matrices A, B, and C, then outputs: D = A + B, E = B − A, F = C * A,
 and G = AT (transpose of A).
 */
 
-#include <iostream>
+#include <string>
 #include <vector>
+#include <cstdlib>
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <memory>
+
+#include "matrix_io.h"
+#include "matrix_gemm.h"
+#include "matrix_threads.h"
+#include "matrix_file.h"
 
 using namespace std;
-class Matrix
+
+// Work-stealing queue of C tiles: every worker starts on its own contiguous
+// run of tiles and, once that is drained, steals from the back of the others.
+class TileScheduler
 {
 private:
-    int n;
-    int m;
-    vector<vector<int>> array;
+    struct Queue
+    {
+        mutex lock;
+        deque<int> tiles;
+    };
+    vector<Queue> queues;
 public:
-    Matrix(int n, int m)
+    TileScheduler(int workers, int tileCount) : queues(workers)
     {
-        this->n = n;
-        this->m = m;
-        this->array = vector<vector<int>>(n, vector<int>(m));
+        for (int t = 0; t < tileCount; t++)
+        {
+            queues[(long long)t * workers / tileCount].tiles.push_back(t);
+        }
     }
 
-    void input()
+    bool next(int worker, int& tile)
     {
-        for (int i = 0; i < n; i++)
+        int workers = queues.size();
+        for (int v = 0; v < workers; v++)
         {
-            for (int j = 0; j < m; j++)
+            Queue& q = queues[(worker + v) % workers];
+            lock_guard<mutex> guard(q.lock);
+            if (!q.tiles.empty())
             {
-                cin >> array[i][j];
+                if (v == 0)
+                {
+                    tile = q.tiles.front();
+                    q.tiles.pop_front();
+                } else
+                {
+                    tile = q.tiles.back();
+                    q.tiles.pop_back();
+                }
+                return true;
             }
         }
+        return false;
     }
+};
 
-    Matrix transposed()
+const int GEMM_TILE_N = 256;
+
+// C += A * B computed by `threads` workers over GEMM_MC x GEMM_TILE_N tiles
+// of C. Every KC x NC block of B is packed once, the workers splitting its
+// panels between them, and is then shared read-only by all tiles of that
+// block. Each worker owns one A buffer and repacks it only when its next
+// tile lies in another row block.
+template <typename T>
+void parallelGemm(int m, int n, int k, const T* a, int lda, const T* b, int ldb, T* c, int ldc, int threads)
+{
+    const int MR = GemmKernel<T>::MR;
+    const int NR = GemmKernel<T>::NR;
+    int rowTiles = (m + GEMM_MC - 1) / GEMM_MC;
+    int colTiles = (min(GEMM_NC, n) + GEMM_TILE_N - 1) / GEMM_TILE_N;
+    threads = max(1, min(threads, rowTiles * colTiles));
+    // all buffers are allocated here, before any worker runs
+    DenseStorage<T> packedB(1, min(GEMM_KC, k) * (min(GEMM_NC, n) + NR));
+    vector<DenseStorage<T>> packedAs;
+    for (int id = 0; id < threads; id++)
     {
-        vector<vector<int>> temp = vector<vector<int>>(m, vector<int>(n));
-        for (int i = 0; i < n; i++)
+        packedAs.emplace_back(1, min(GEMM_MC, m) * min(GEMM_KC, k) + MR * GEMM_KC);
+    }
+    SweepBarrier barrier(threads);
+    unique_ptr<TileScheduler> scheduler;
+    auto worker = [&](int id)
+    {
+        DenseStorage<T>& packedA = packedAs[id];
+        for (int jc = 0; jc < n; jc += GEMM_NC)
         {
-            for (int j = 0; j < m; j++)
+            int nc = min(GEMM_NC, n - jc);
+            int blockColTiles = (nc + GEMM_TILE_N - 1) / GEMM_TILE_N;
+            for (int pc = 0; pc < k; pc += GEMM_KC)
             {
-                temp[j][i] = array[i][j];
+                int kc = min(GEMM_KC, k - pc);
+                // every tile of the previous block is done with packedB
+                barrier.wait();
+                if (id == 0) scheduler.reset(new TileScheduler(threads, rowTiles * blockColTiles));
+                int panels = (nc + NR - 1) / NR;
+                int first = (long long)panels * id / threads * NR;
+                int last = min(nc, (int)((long long)panels * (id + 1) / threads * NR));
+                if (first < last)
+                {
+                    packPanelsB(kc, last - first, b + (size_t)pc * ldb + jc + first, ldb,
+                                packedB.getData() + (size_t)first * kc);
+                }
+                barrier.wait();
+
+                int tile, packedRow = -1;
+                while (scheduler->next(id, tile))
+                {
+                    int i0 = tile / blockColTiles * GEMM_MC;
+                    int j0 = tile % blockColTiles * GEMM_TILE_N;
+                    int mc = min(GEMM_MC, m - i0);
+                    int tn = min(GEMM_TILE_N, nc - j0);
+                    if (i0 != packedRow)
+                    {
+                        packPanelsA(mc, kc, a + (size_t)i0 * lda + pc, lda, packedA.getData());
+                        packedRow = i0;
+                    }
+                    for (int jr = 0; jr < tn; jr += NR)
+                    {
+                        const T* panelB = packedB.getData() + (size_t)(j0 + jr) * kc;
+                        for (int ir = 0; ir < mc; ir += MR)
+                        {
+                            const T* panelA = packedA.getData() + (size_t)ir * kc;
+                            T* tileC = c + (size_t)(i0 + ir) * ldc + jc + j0 + jr;
+                            GemmKernel<T>::run(kc, panelA, panelB, tileC, ldc, min(MR, mc - ir), min(NR, tn - jr));
+                        }
+                    }
+                }
             }
         }
+    };
+    vector<thread> pool;
+    for (int id = 1; id < threads; id++)
+    {
+        pool.emplace_back(worker, id);
+    }
+    worker(0);
+    for (thread& t : pool)
+    {
+        t.join();
+    }
+}
+
+// Base of the lazy elementwise expressions (A + B, A - B, alpha * A).
+// Nothing is computed until an expression is assigned to a Matrix, which
+// then evaluates every element in one fused pass over the operands.
+template <typename E>
+struct MatrixExpr
+{
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+class Matrix : public MatrixExpr<Matrix>
+{
+private:
+    int n;
+    int m;
+    DenseStorage<int> array;
+public:
+    // worker threads used by operator*; set from MATRIX_THREADS in main()
+    static int threads;
+
+    Matrix(int n, int m)
+    {
+        this->n = n;
+        this->m = m;
+        this->array = DenseStorage<int>(n, m);
+    }
+
+    template <typename E>
+    Matrix(const MatrixExpr<E>& expr)
+    {
+        this->n = 0;
+        this->m = 0;
+        *this = expr;
+    }
+
+    int rows() const { return n; }
+    int cols() const { return m; }
+    int operator()(int i, int j) const { return array[i][j]; }
+
+    void input()
+    {
+        stdinReader().readBlock(array.getData(), n, m, array.getStride());
+    }
+
+    Matrix transposed()
+    {
         Matrix ma(m, n);
-        ma.array = temp;
+        transposeBlock(n, m, array.getData(), array.getStride(), ma.array.getData(), ma.array.getStride());
         return ma;
     }
 
-    void output()
+    static Matrix load(const char* path)
     {
-        for (int i = 0; i < n; i++)
-        {
-            for (int j = 0; j < m - 1; j++)
-            {
-                cout << array[i][j] << " ";
-            }
-            cout << array[i][m - 1];
-            cout << '\n';
-        }
+        Matrix ma(0, 0);
+        ma.array = readMatrixFile<int>(path);
+        ma.n = ma.array.getRows();
+        ma.m = ma.array.getCols();
+        return ma;
     }
 
-    Matrix operator+(const Matrix& ma)
+    void save(const char* path, bool sparse = false) const
     {
-        if (!(ma.n == n && ma.m == m))
-        {
-            cout << "Error: the dimensional problem occurred" << endl;
-            vector<vector<int>> temp = vector<vector<int>>(0, vector<int>(0));
-            Matrix Temporary(0, 0);
-            Temporary.array = temp;
-            return Temporary;
-        } else
+        if (!saveMatrixFile(path, array, sparse))
         {
-            vector<vector<int>> temp = vector<vector<int>>(n, vector<int>(m));
-            vector<vector<int>> a1 = ma.array;
-            for (int i = 0; i < n; i++)
-            {
-                for (int j = 0; j < m; j++)
-                {
-                    temp[i][j] = array[i][j] + a1[i][j];
-                }
-            }
-            Matrix Temporary(n, m);
-            Temporary.array = temp;
-            return Temporary;
+            stdoutWriter() << "Error: cannot write matrix file " << path << '\n';
         }
     }
 
-    Matrix operator-(const Matrix& ma)
+    void output()
     {
-        if (!(ma.n == n && ma.m == m))
-        {
-            cout << "Error: the dimensional problem occurred" << endl;
-            vector<vector<int>> temp = vector<vector<int>>(0, vector<int>(0));
-            Matrix Temporary(0, 0);
-            Temporary.array = temp;
-            return Temporary;
-        } else
+        for (int i = 0; i < n; i++)
         {
-            vector<vector<int>> temp = vector<vector<int>>(n, vector<int>(m));
-            vector<vector<int>> a1 = ma.array;
-            for (int i = 0; i < n; i++)
+            for (int j = 0; j < m - 1; j++)
             {
-                for (int j = 0; j < m; j++)
-                {
-                    temp[i][j] = array[i][j] - a1[i][j];
-                }
+                stdoutWriter() << array[i][j] << " ";
             }
-            Matrix Temporary(n, m);
-            Temporary.array = temp;
-            return Temporary;
+            stdoutWriter() << array[i][m - 1];
+            stdoutWriter() << '\n';
         }
     }
 
@@ -124,49 +241,208 @@ public:
     {
         if (m == ma.n)
         {
-            vector<vector<int>> temp = vector<vector<int>>(n, vector<int>(ma.m, 0));
-            vector<vector<int>> a1 = ma.array;
-            for (int i = 0; i < n; i++)
+            Matrix Temporary(n, ma.m);
+            if (threads > 1 && (long long)n * ma.m * m >= 64LL * 64 * 64)
             {
-                for (int j = 0; j < ma.m; j++)
-                {
-                    for (int c = 0; c < m; c++)
-                    {
-                        temp[i][j] += array[i][c] * a1[c][j];
-                    }
-                }
+                parallelGemm(n, ma.m, m, array.getData(), array.getStride(),
+                             ma.array.getData(), ma.array.getStride(),
+                             Temporary.array.getData(), Temporary.array.getStride(), threads);
+            } else
+            {
+                gemm(n, ma.m, m, array.getData(), array.getStride(),
+                     ma.array.getData(), ma.array.getStride(),
+                     Temporary.array.getData(), Temporary.array.getStride());
             }
-            Matrix Temporary(n, ma.m);
-            Temporary.array = temp;
             return Temporary;
         } else
         {
-            cout << "Error: the dimensional problem occurred" << endl;
-            vector<vector<int>> temp = vector<vector<int>>(0, vector<int>(0));
-            Matrix Temporary(0, 0);
-            Temporary.array = temp;
-            return Temporary;
+            stdoutWriter() << "Error: the dimensional problem occurred" << '\n';
+            return Matrix(0, 0);
         }
     }
 
-    void operator=(const Matrix& ma)
+    Matrix(const Matrix& ma) = default;
+    Matrix(Matrix&& ma) = default;
+
+    Matrix& operator=(const Matrix& ma)
     {
         array = ma.array;
         n = ma.n;
         m = ma.m;
+        return *this;
     }
+
+    Matrix& operator=(Matrix&& ma)
+    {
+        array = std::move(ma.array);
+        n = ma.n;
+        m = ma.m;
+        return *this;
+    }
+
+    Matrix& operator*=(const Matrix& ma)
+    {
+        return *this = *this * ma;
+    }
+
+    // writes the expression straight into this matrix's storage; each
+    // element only reads the same position of the operands, so A = A + B is safe
+    template <typename E>
+    Matrix& operator=(const MatrixExpr<E>& expr)
+    {
+        const E& e = expr.self();
+        if (n != e.rows() || m != e.cols())
+        {
+            n = e.rows();
+            m = e.cols();
+            array = DenseStorage<int>(n, m);
+        }
+        for (int i = 0; i < n; i++)
+        {
+            int* row = array[i];
+            for (int j = 0; j < m; j++)
+            {
+                row[j] = e(i, j);
+            }
+        }
+        return *this;
+    }
+
+    template <typename E>
+    Matrix& operator+=(const MatrixExpr<E>& expr);
+
+    template <typename E>
+    Matrix& operator-=(const MatrixExpr<E>& expr);
+};
+
+// Matrices are held by reference inside an expression, nested expressions by value.
+template <typename E>
+struct ExprOperand
+{
+    typedef const E type;
+};
+
+template <>
+struct ExprOperand<Matrix>
+{
+    typedef const Matrix& type;
+};
+
+struct AddOp
+{
+    static int apply(int x, int y) { return x + y; }
 };
 
-int main()
+struct SubtractOp
 {
+    static int apply(int x, int y) { return x - y; }
+};
+
+template <typename L, typename R, typename Op>
+class ElementwiseExpr : public MatrixExpr<ElementwiseExpr<L, R, Op>>
+{
+private:
+    typename ExprOperand<L>::type left;
+    typename ExprOperand<R>::type right;
+    int n;
+    int m;
+public:
+    ElementwiseExpr(const L& left, const R& right) : left(left), right(right)
+    {
+        n = left.rows();
+        m = left.cols();
+        if (!(right.rows() == n && right.cols() == m))
+        {
+            stdoutWriter() << "Error: the dimensional problem occurred" << '\n';
+            n = 0;
+            m = 0;
+        }
+    }
+
+    int rows() const { return n; }
+    int cols() const { return m; }
+    int operator()(int i, int j) const { return Op::apply(left(i, j), right(i, j)); }
+};
+
+template <typename E>
+class ScaledExpr : public MatrixExpr<ScaledExpr<E>>
+{
+private:
+    int alpha;
+    typename ExprOperand<E>::type expr;
+public:
+    ScaledExpr(int alpha, const E& expr) : alpha(alpha), expr(expr) {}
+
+    int rows() const { return expr.rows(); }
+    int cols() const { return expr.cols(); }
+    int operator()(int i, int j) const { return alpha * expr(i, j); }
+};
+
+template <typename L, typename R>
+ElementwiseExpr<L, R, AddOp> operator+(const MatrixExpr<L>& left, const MatrixExpr<R>& right)
+{
+    return ElementwiseExpr<L, R, AddOp>(left.self(), right.self());
+}
+
+template <typename L, typename R>
+ElementwiseExpr<L, R, SubtractOp> operator-(const MatrixExpr<L>& left, const MatrixExpr<R>& right)
+{
+    return ElementwiseExpr<L, R, SubtractOp>(left.self(), right.self());
+}
+
+template <typename E>
+ScaledExpr<E> operator*(int alpha, const MatrixExpr<E>& expr)
+{
+    return ScaledExpr<E>(alpha, expr.self());
+}
+
+template <typename E>
+Matrix& Matrix::operator+=(const MatrixExpr<E>& expr)
+{
+    return *this = *this + expr;
+}
+
+template <typename E>
+Matrix& Matrix::operator-=(const MatrixExpr<E>& expr)
+{
+    return *this = *this - expr;
+}
+
+int Matrix::threads = max(1, (int)thread::hardware_concurrency());
+
+int main(int argc, char* argv[])
+{
+    if (getenv("MATRIX_THREADS"))
+    {
+        Matrix::threads = max(1, atoi(getenv("MATRIX_THREADS")));
+    }
+
+    // binary mode: matrix_calculator A.bin B.bin C.bin <prefix>
+    // writes <prefix>D.bin, <prefix>E.bin, <prefix>F.bin and <prefix>G.bin
+    if (argc == 5)
+    {
+        Matrix A = Matrix::load(argv[1]);
+        Matrix B = Matrix::load(argv[2]);
+        Matrix C = Matrix::load(argv[3]);
+        string prefix = argv[4];
+        Matrix D = A + B;
+        D.save((prefix + "D.bin").c_str());
+        Matrix E = B - A;
+        E.save((prefix + "E.bin").c_str());
+        Matrix F = C * A;
+        F.save((prefix + "F.bin").c_str());
+        Matrix G = A.transposed();
+        G.save((prefix + "G.bin").c_str());
+        return 0;
+    }
     int n1, m1, n2, m2, n3, m3;
-    cin >> n1 >> m1;
+    stdinReader() >> n1 >> m1;
     Matrix A(n1, m1);
     A.input();
-    cin >> n2 >> m2;
+    stdinReader() >> n2 >> m2;
     Matrix B(n2, m2);
     B.input();
-    cin >> n3 >> m3;
+    stdinReader() >> n3 >> m3;
     Matrix C(n3, m3);
     C.input();
 
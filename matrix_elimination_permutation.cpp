@@ -7,30 +7,27 @@ elimination matrices nullify specific elements, and permutation matrices swap ro
 All matrices use integer elements.
 */
 
-#include <iostream>
-#include <vector>
+#include <utility>
+#include <type_traits>
+
+#include "matrix_io.h"
 
 using namespace std;
+
 class Matrix
 {
 public:
     int n;
-    vector<vector<int>> array;
+    DenseStorage<int> array;
     Matrix(int n)
     {
         this->n = n;
-        this->array = vector<vector<int>>(n, vector<int>(n));
+        this->array = DenseStorage<int>(n, n);
     }
 
     void input()
     {
-        for (int i = 0; i < n; i++)
-        {
-            for (int j = 0; j < n; j++)
-            {
-                cin >> array[i][j];
-            }
-        }
+        stdinReader().readBlock(array.getData(), n, n, array.getStride());
     }
 
     void output()
@@ -39,10 +36,10 @@ public:
         {
             for (int j = 0; j < n - 1; j++)
             {
-                cout << array[i][j] << " ";
+                stdoutWriter() << array[i][j] << " ";
             }
-            cout << array[i][n - 1];
-            cout << '\n';
+            stdoutWriter() << array[i][n - 1];
+            stdoutWriter() << '\n';
         }
     }
 
@@ -50,24 +47,18 @@ public:
     {
         if (ma.n != n)
         {
-            cout << "Error: the dimensional problem occurred" << endl;
-            vector<vector<int>> temp = vector<vector<int>>(0, vector<int>(0));
-            Matrix Temporary(0);
-            Temporary.array = temp;
-            return Temporary;
+            stdoutWriter() << "Error: the dimensional problem occurred" << '\n';
+            return Matrix(0);
         } else
         {
-            vector<vector<int>> temp = vector<vector<int>>(n, vector<int>(n));
-            vector<vector<int>> a1 = ma.array;
+            Matrix Temporary(n);
             for (int i = 0; i < n; i++)
             {
                 for (int j = 0; j < n; j++)
                 {
-                    temp[i][j] = array[i][j] + a1[i][j];
+                    Temporary.array[i][j] = array[i][j] + ma.array[i][j];
                 }
             }
-            Matrix Temporary(n);
-            Temporary.array = temp;
             return Temporary;
         }
     }
@@ -76,71 +67,301 @@ public:
     {
         if (ma.n != n)
         {
-            cout << "Error: the dimensional problem occurred" << endl;
-            vector<vector<int>> temp = vector<vector<int>>(0, vector<int>(0));
-            Matrix Temporary(0);
-            Temporary.array = temp;
-            return Temporary;
+            stdoutWriter() << "Error: the dimensional problem occurred" << '\n';
+            return Matrix(0);
         } else
         {
-            vector<vector<int>> temp = vector<vector<int>>(n, vector<int>(n));
-            vector<vector<int>> a1 = ma.array;
+            Matrix Temporary(n);
             for (int i = 0; i < n; i++)
             {
                 for (int j = 0; j < n; j++)
                 {
-                    temp[i][j] = array[i][j] - a1[i][j];
+                    Temporary.array[i][j] = array[i][j] - ma.array[i][j];
                 }
             }
-            Matrix Temporary(n);
-            Temporary.array = temp;
             return Temporary;
         }
     }
 
+    Matrix& operator+=(const Matrix& ma)
+    {
+        if (ma.n != n)
+        {
+            stdoutWriter() << "Error: the dimensional problem occurred" << '\n';
+            return *this = Matrix(0);
+        }
+        for (int i = 0; i < n; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                array[i][j] += ma.array[i][j];
+            }
+        }
+        return *this;
+    }
+
+    Matrix& operator-=(const Matrix& ma)
+    {
+        if (ma.n != n)
+        {
+            stdoutWriter() << "Error: the dimensional problem occurred" << '\n';
+            return *this = Matrix(0);
+        }
+        for (int i = 0; i < n; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                array[i][j] -= ma.array[i][j];
+            }
+        }
+        return *this;
+    }
+
     Matrix operator*(const Matrix& ma)
     {
         if (n == ma.n)
         {
-            vector<vector<int>> temp = vector<vector<int>>(n, vector<int>(ma.n, 0));
-            vector<vector<int>> a1 = ma.array;
+            Matrix Temporary(n);
             for (int i = 0; i < n; i++)
             {
-                for (int j = 0; j < ma.n; j++)
+                int* row = Temporary.array[i];
+                for (int c = 0; c < n; c++)
                 {
-                    for (int c = 0; c < n; c++)
+                    int k = array[i][c];
+                    const int* src = ma.array[c];
+                    for (int j = 0; j < ma.n; j++)
                     {
-                        temp[i][j] += array[i][c] * a1[c][j];
+                        row[j] += k * src[j];
                     }
                 }
             }
-            Matrix Temporary(n);
-            Temporary.array = temp;
             return Temporary;
         } else
         {
-            cout << "Error: the dimensional problem occurred" << endl;
-            vector<vector<int>> temp = vector<vector<int>>(0, vector<int>(0));
-            Matrix Temporary(0);
-            Temporary.array = temp;
-            return Temporary;
+            stdoutWriter() << "Error: the dimensional problem occurred" << '\n';
+            return Matrix(0);
         }
     }
 
-    void setArray(vector<vector<int>> t)
+    void setArray(DenseStorage<int> t)
     {
         array = std::move(t);
     }
 
-    vector<vector<int>> getArray()
+    DenseStorage<int>& getArray()
     {
         return array;
     }
 
-    void operator=(const Matrix& ma)
+    const DenseStorage<int>& getArray() const
+    {
+        return array;
+    }
+
+    Matrix(const Matrix& ma) = default;
+    Matrix(Matrix&& ma) = default;
+
+    Matrix& operator=(const Matrix& ma)
     {
         array = ma.array;
         n = ma.n;
+        return *this;
+    }
+
+    Matrix& operator=(Matrix&& ma)
+    {
+        array = std::move(ma.array);
+        n = ma.n;
+        return *this;
+    }
+
+    Matrix& operator*=(const Matrix& ma)
+    {
+        return *this = *this * ma;
+    }
+};
+
+// Calls f(integral_constant<int, 0>()) ... f(integral_constant<int, N - 1>())
+// as straight-line code, so the fixed-size loops below have no loop at all.
+template <typename F, int... I>
+inline void unrolled(F&& f, integer_sequence<int, I...>)
+{
+    (f(integral_constant<int, I>()), ...);
+}
+
+template <int N, typename F>
+inline void unroll(F&& f)
+{
+    unrolled(f, make_integer_sequence<int, N>());
+}
+
+// R x C matrix whose size is a compile-time constant. The elements live
+// inline (on the stack for locals), every loop is unrolled, and nothing
+// allocates, so 3x3 / 4x4 hot loops cost just their arithmetic. Convert
+// to and from the dynamic Matrix with fromDynamic() / toDynamic().
+template <int R, int C, typename T>
+class FixedMatrix
+{
+public:
+    T array[R][C] = {};
+
+    static FixedMatrix identity()
+    {
+        static_assert(R == C, "identity needs a square matrix");
+        FixedMatrix result;
+        unroll<R>([&](auto i) { result.array[i][i] = 1; });
+        return result;
+    }
+
+    T* operator[](int i)
+    {
+        return array[i];
+    }
+
+    const T* operator[](int i) const
+    {
+        return array[i];
+    }
+
+    // integers as they are, floating point with two decimals
+    static void print(T value)
+    {
+        if constexpr (is_floating_point<T>::value)
+        {
+            stdoutWriter() << Fixed{value, 2};
+        } else
+        {
+            stdoutWriter() << value;
+        }
+    }
+
+    void output() const
+    {
+        for (int i = 0; i < R; i++)
+        {
+            for (int j = 0; j < C - 1; j++)
+            {
+                print(array[i][j]);
+                stdoutWriter() << " ";
+            }
+            print(array[i][C - 1]);
+            stdoutWriter() << '\n';
+        }
+    }
+
+    FixedMatrix operator+(const FixedMatrix& ma) const
+    {
+        FixedMatrix result;
+        unroll<R>([&](auto i) { unroll<C>([&](auto j) { result.array[i][j] = array[i][j] + ma.array[i][j]; }); });
+        return result;
+    }
+
+    FixedMatrix operator-(const FixedMatrix& ma) const
+    {
+        FixedMatrix result;
+        unroll<R>([&](auto i) { unroll<C>([&](auto j) { result.array[i][j] = array[i][j] - ma.array[i][j]; }); });
+        return result;
+    }
+
+    template <int K>
+    FixedMatrix<R, K, T> operator*(const FixedMatrix<C, K, T>& ma) const
+    {
+        FixedMatrix<R, K, T> result;
+        unroll<R>([&](auto i)
+        {
+            unroll<C>([&](auto c)
+            {
+                unroll<K>([&](auto j) { result.array[i][j] += array[i][c] * ma.array[c][j]; });
+            });
+        });
+        return result;
+    }
+
+    FixedMatrix<C, R, T> transpose() const
+    {
+        FixedMatrix<C, R, T> result;
+        unroll<R>([&](auto i) { unroll<C>([&](auto j) { result.array[j][i] = array[i][j]; }); });
+        return result;
+    }
+
+    // the matrix without row `row` and column `col`
+    FixedMatrix<R - 1, C - 1, T> minor(int row, int col) const
+    {
+        FixedMatrix<R - 1, C - 1, T> result;
+        unroll<R - 1>([&](auto i)
+        {
+            unroll<C - 1>([&](auto j)
+            {
+                result.array[i][j] = array[i + (i >= row)][j + (j >= col)];
+            });
+        });
+        return result;
+    }
+
+    // Laplace expansion along the first row; exact for integer T and
+    // branch-free, meant for the small sizes this class is for
+    T determinant() const
+    {
+        static_assert(R == C, "determinant needs a square matrix");
+        if constexpr (R == 1)
+        {
+            return array[0][0];
+        } else if constexpr (R == 2)
+        {
+            return array[0][0] * array[1][1] - array[0][1] * array[1][0];
+        } else
+        {
+            T det = 0;
+            unroll<C>([&](auto j)
+            {
+                T term = array[0][j] * minor(0, j).determinant();
+                det += j % 2 == 0 ? term : -term;
+            });
+            return det;
+        }
+    }
+
+    // adjugate / det; the caller checks determinant() != 0 first
+    FixedMatrix<R, C, double> inverse() const
+    {
+        static_assert(R == C, "inverse needs a square matrix");
+        FixedMatrix<R, C, double> result;
+        double det = determinant();
+        if constexpr (R == 1)
+        {
+            result.array[0][0] = 1 / det;
+        } else
+        {
+            unroll<R>([&](auto i)
+            {
+                unroll<C>([&](auto j)
+                {
+                    double cofactor = minor(i, j).determinant();
+                    result.array[j][i] = ((i + j) % 2 == 0 ? cofactor : -cofactor) / det;
+                });
+            });
+        }
+        return result;
+    }
+
+    static FixedMatrix fromDynamic(const Matrix& ma)
+    {
+        FixedMatrix result;
+        if (ma.n != R || ma.n != C)
+        {
+            stdoutWriter() << "Error: the dimensional problem occurred" << '\n';
+            return result;
+        }
+        unroll<R>([&](auto i) { unroll<C>([&](auto j) { result.array[i][j] = ma.array[i][j]; }); });
+        return result;
+    }
+
+    Matrix toDynamic() const
+    {
+        static_assert(R == C, "the dynamic Matrix is square");
+        Matrix result(R);
+        unroll<R>([&](auto i) { unroll<C>([&](auto j) { result.array[i][j] = array[i][j]; }); });
+        return result;
     }
 };
 
@@ -150,7 +371,7 @@ public:
     IdentityMatrix(int n) : Matrix(n)
     {
         this->n = n;
-        this->array = vector<vector<int>>(n, vector<int>(n, 0));
+        this->array = DenseStorage<int>(n, n, 0);
         for (int i = 0; i < n; i++)
         {
             array[i][i]=1;
@@ -164,12 +385,12 @@ public:
     EliminationMatrix(int n) : Matrix(n)
     {
         this->n = n;
-        this->array = vector<vector<int>>(n, vector<int>(n));
+        this->array = DenseStorage<int>(n, n);
     }
 
     void makeElimination(int q, int w, int el)
     {
-        array = vector<vector<int>>(n, vector<int>(n, 0));
+        array = DenseStorage<int>(n, n, 0);
         q -= 1;
         w -= 1;
         for (int i = 0; i < n; i++)
@@ -199,26 +420,25 @@ public:
     PermutationMatrix(int n) : Matrix(n)
     {
         this->n = n;
-        this->array = vector<vector<int>>(n, vector<int>(n));
+        this->array = DenseStorage<int>(n, n);
     }
 
     void makePermutation(int q, int w)
     {
         q -= 1;
         w -= 1;
-        swap(array[q], array[w]);
+        array.swapRows(q, w);
     }
 };
 
 int main()
 {
     int n;
-    cin >> n;
+    stdinReader() >> n;
     Matrix A(n); // temporary matrix
     A.input();
 
-    IdentityMatrix I(3); // I
-    I.output();
+    FixedMatrix<3, 3, int>::identity().output(); // I
 
     EliminationMatrix E21(n); // E_21
     E21.setArray(A.getArray());
@@ -0,0 +1,238 @@
+/*
+The binary matrix file format shared by the programs that read or write
+matrices as files instead of text: a fixed header plus dense or CSR
+sections, laid out so that a dense file can be mapped and used in place.
+*/
+
+#ifndef MATRIX_FILE_H
+#define MATRIX_FILE_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <climits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "matrix_io.h"
+
+// Binary matrix files, laid out for mmap(): a 64-byte header followed by
+// 64-byte aligned sections. Dense files keep rows exactly as DenseStorage
+// does (row-major, strideFor(cols) elements apart), so a file of the
+// matching dtype is used in place without copying. CSR files hold rowPtr
+// (rows + 1 x uint64), colIndex (nnz x uint32) and values (nnz x dtype).
+struct MatrixFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    uint32_t layout;
+    uint32_t reserved;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t stride;
+    uint64_t nnz;
+    uint64_t dataOffset;
+};
+
+const char MATRIX_FILE_MAGIC[8] = {'M', 'A', 'T', 'R', 'I', 'X', 'B', '1'};
+const uint32_t DTYPE_INT32 = 1;
+const uint32_t DTYPE_FLOAT64 = 2;
+const uint32_t LAYOUT_DENSE = 0;
+const uint32_t LAYOUT_CSR = 1;
+
+template <typename T>
+struct MatrixFileType;
+
+template <>
+struct MatrixFileType<int>
+{
+    static const uint32_t dtype = DTYPE_INT32;
+};
+
+template <>
+struct MatrixFileType<double>
+{
+    static const uint32_t dtype = DTYPE_FLOAT64;
+};
+
+inline uint64_t alignSection(uint64_t bytes)
+{
+    return (bytes + 63) / 64 * 64;
+}
+
+// private (copy-on-write) mapping of a whole file, unmapped with its last owner
+struct FileMapping
+{
+    void* base;
+    size_t size;
+
+    ~FileMapping()
+    {
+        munmap(base, size);
+    }
+};
+
+template <typename T>
+T readElement(const char* p, uint32_t dtype)
+{
+    if (dtype == DTYPE_INT32)
+    {
+        int32_t value;
+        memcpy(&value, p, sizeof(value));
+        return (T)value;
+    }
+    double value;
+    memcpy(&value, p, sizeof(value));
+    return (T)value;
+}
+
+// Dense files of the same dtype are wrapped in place; other dtypes and CSR
+// files are converted into freshly allocated storage.
+template <typename T>
+bool loadMatrixFile(const char* path, DenseStorage<T>& out)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(MatrixFileHeader))
+    {
+        close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return false;
+    std::shared_ptr<FileMapping> mapping(new FileMapping{base, size});
+
+    MatrixFileHeader h;
+    memcpy(&h, base, sizeof(h));
+    if (memcmp(h.magic, MATRIX_FILE_MAGIC, sizeof(h.magic)) != 0 || h.version != 1) return false;
+    if (h.dtype != DTYPE_INT32 && h.dtype != DTYPE_FLOAT64) return false;
+    // cols leaves room for the padding so strideFor(cols) stays an int
+    if (h.rows > INT_MAX || h.cols > INT_MAX - 64 || h.dataOffset % 64 != 0 || h.dataOffset > size) return false;
+    int rows = h.rows;
+    int cols = h.cols;
+    size_t width = h.dtype == DTYPE_INT32 ? 4 : 8;
+    const char* data = (const char*)base + h.dataOffset;
+    size_t available = size - h.dataOffset;
+
+    if (h.layout == LAYOUT_DENSE)
+    {
+        // rows * stride * width <= available, by division so that a corrupt
+        // header cannot wrap the product around
+        if (h.stride < h.cols || (h.rows != 0 && h.stride > available / width / h.rows)) return false;
+        if (h.dtype == MatrixFileType<T>::dtype && h.stride == (uint64_t)DenseStorage<T>::strideFor(cols))
+        {
+            out = DenseStorage<T>((T*)data, rows, cols, mapping);
+            return true;
+        }
+        out = DenseStorage<T>(rows, cols);
+        for (int i = 0; i < rows; i++)
+        {
+            const char* row = data + i * h.stride * width;
+            for (int j = 0; j < cols; j++)
+            {
+                out[i][j] = readElement<T>(row + j * width, h.dtype);
+            }
+        }
+        return true;
+    }
+    if (h.layout == LAYOUT_CSR)
+    {
+        // nnz is bounded by the file before it is multiplied by anything, and
+        // the dense result must be addressable
+        if (h.nnz > available / width) return false;
+        if (cols != 0 && h.rows > SIZE_MAX / sizeof(T) / DenseStorage<T>::strideFor(cols)) return false;
+        uint64_t indexOffset = alignSection((h.rows + 1) * sizeof(uint64_t));
+        uint64_t valueOffset = indexOffset + alignSection(h.nnz * sizeof(uint32_t));
+        if (valueOffset + h.nnz * width > available) return false;
+        const uint64_t* rowPtr = (const uint64_t*)data;
+        const uint32_t* colIndex = (const uint32_t*)(data + indexOffset);
+        out = DenseStorage<T>(rows, cols);
+        for (int i = 0; i < rows; i++)
+        {
+            if (rowPtr[i] > rowPtr[i + 1] || rowPtr[i + 1] > h.nnz) return false;
+            for (uint64_t k = rowPtr[i]; k < rowPtr[i + 1]; k++)
+            {
+                if (colIndex[k] >= h.cols) return false;
+                out[i][colIndex[k]] = readElement<T>(data + valueOffset + k * width, h.dtype);
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+// writes the storage as a dense file, or as CSR holding only its non-zeros
+template <typename T>
+bool saveMatrixFile(const char* path, const DenseStorage<T>& m, bool sparse)
+{
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    MatrixFileHeader h = {};
+    memcpy(h.magic, MATRIX_FILE_MAGIC, sizeof(h.magic));
+    h.version = 1;
+    h.dtype = MatrixFileType<T>::dtype;
+    h.layout = sparse ? LAYOUT_CSR : LAYOUT_DENSE;
+    h.rows = m.getRows();
+    h.cols = m.getCols();
+    h.dataOffset = alignSection(sizeof(h));
+    const char zeros[64] = {};
+    bool ok;
+    if (!sparse)
+    {
+        h.stride = m.getStride();
+        ok = fwrite(&h, sizeof(h), 1, f) == 1
+             && fwrite(m.getData(), sizeof(T), h.rows * h.stride, f) == h.rows * h.stride;
+    } else
+    {
+        std::vector<uint64_t> rowPtr(1, 0);
+        std::vector<uint32_t> colIndex;
+        std::vector<T> values;
+        for (int i = 0; i < m.getRows(); i++)
+        {
+            for (int j = 0; j < m.getCols(); j++)
+            {
+                if (m[i][j] != T())
+                {
+                    colIndex.push_back(j);
+                    values.push_back(m[i][j]);
+                }
+            }
+            rowPtr.push_back(values.size());
+        }
+        h.nnz = values.size();
+        size_t rowBytes = rowPtr.size() * sizeof(uint64_t);
+        size_t indexBytes = colIndex.size() * sizeof(uint32_t);
+        ok = fwrite(&h, sizeof(h), 1, f) == 1
+             && fwrite(rowPtr.data(), 1, rowBytes, f) == rowBytes
+             && fwrite(zeros, 1, alignSection(rowBytes) - rowBytes, f) == alignSection(rowBytes) - rowBytes
+             && fwrite(colIndex.data(), 1, indexBytes, f) == indexBytes
+             && fwrite(zeros, 1, alignSection(indexBytes) - indexBytes, f) == alignSection(indexBytes) - indexBytes
+             && fwrite(values.data(), sizeof(T), values.size(), f) == values.size();
+    }
+    return fclose(f) == 0 && ok;
+}
+
+// loadMatrixFile() for the command-line programs: a file that cannot be
+// read ends the program with an error line
+template <typename T>
+DenseStorage<T> readMatrixFile(const char* path)
+{
+    DenseStorage<T> result;
+    if (!loadMatrixFile(path, result))
+    {
+        stdoutWriter() << "Error: cannot read matrix file " << path << '\n';
+        exit(0);
+    }
+    return result;
+}
+
+#endif
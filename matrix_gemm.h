@@ -0,0 +1,184 @@
+/*
+The blocked GEMM engine shared by the programs that multiply or factor
+dense matrices: C += A * B with packed panels and a register-blocked
+microkernel.
+*/
+
+#ifndef MATRIX_GEMM_H
+#define MATRIX_GEMM_H
+
+#include <algorithm>
+#include <cstring>
+
+#include "matrix_io.h"
+
+// Blocked GEMM engine: C += A * B for row-major operands with leading
+// dimensions lda/ldb/ldc. B is packed into KC x NC panels (L3), A into
+// MC x KC blocks (L2), and an MR x NR register-blocked microkernel walks
+// them from L1. With GCC/Clang vector extensions the microkernel compiles to
+// AVX-512, AVX2 or SSE2 depending on the target; other compilers get a
+// scalar kernel.
+#if defined(__AVX512F__)
+#define GEMM_VECTOR_BYTES 64
+#elif defined(__AVX2__)
+#define GEMM_VECTOR_BYTES 32
+#else
+#define GEMM_VECTOR_BYTES 16
+#endif
+
+template <typename T>
+struct GemmKernel
+{
+#if defined(__GNUC__)
+    static constexpr int LANES = GEMM_VECTOR_BYTES / sizeof(T);
+    static constexpr int MR = 6;
+    static constexpr int NR = 2 * LANES;
+    typedef T Vec __attribute__((vector_size(GEMM_VECTOR_BYTES)));
+
+    static void run(int kc, const T* a, const T* b, T* c, int ldc, int mr, int nr)
+    {
+        Vec acc[MR][2] = {};
+        for (int p = 0; p < kc; p++)
+        {
+            Vec b0, b1;
+            memcpy(&b0, b + p * NR, sizeof(Vec));
+            memcpy(&b1, b + p * NR + LANES, sizeof(Vec));
+            for (int i = 0; i < MR; i++)
+            {
+                Vec ai = Vec{} + a[p * MR + i];
+                acc[i][0] += ai * b0;
+                acc[i][1] += ai * b1;
+            }
+        }
+        T tile[MR][NR];
+        memcpy(tile, acc, sizeof(tile));
+        for (int i = 0; i < mr; i++)
+        {
+            for (int j = 0; j < nr; j++)
+            {
+                c[(size_t)i * ldc + j] += tile[i][j];
+            }
+        }
+    }
+#else
+    static constexpr int MR = 4;
+    static constexpr int NR = 4;
+
+    static void run(int kc, const T* a, const T* b, T* c, int ldc, int mr, int nr)
+    {
+        T acc[MR][NR] = {};
+        for (int p = 0; p < kc; p++)
+        {
+            for (int i = 0; i < MR; i++)
+            {
+                for (int j = 0; j < NR; j++)
+                {
+                    acc[i][j] += a[p * MR + i] * b[p * NR + j];
+                }
+            }
+        }
+        for (int i = 0; i < mr; i++)
+        {
+            for (int j = 0; j < nr; j++)
+            {
+                c[(size_t)i * ldc + j] += acc[i][j];
+            }
+        }
+    }
+#endif
+};
+
+const int GEMM_MC = 96;
+const int GEMM_KC = 256;
+const int GEMM_NC = 4096;
+
+// packs a kc x nc block of B into column panels of NR, zero-padding the last one
+template <typename T>
+void packPanelsB(int kc, int nc, const T* b, int ldb, T* out)
+{
+    const int NR = GemmKernel<T>::NR;
+    for (int jr = 0; jr < nc; jr += NR)
+    {
+        int nr = std::min(NR, nc - jr);
+        for (int p = 0; p < kc; p++)
+        {
+            const T* src = b + (size_t)p * ldb + jr;
+            for (int j = 0; j < nr; j++) *out++ = src[j];
+            for (int j = nr; j < NR; j++) *out++ = T();
+        }
+    }
+}
+
+// packs an mc x kc block of A into row panels of MR, zero-padding the last one
+template <typename T>
+void packPanelsA(int mc, int kc, const T* a, int lda, T* out)
+{
+    const int MR = GemmKernel<T>::MR;
+    for (int ir = 0; ir < mc; ir += MR)
+    {
+        int mr = std::min(MR, mc - ir);
+        for (int p = 0; p < kc; p++)
+        {
+            for (int i = 0; i < mr; i++) *out++ = a[(size_t)(ir + i) * lda + p];
+            for (int i = mr; i < MR; i++) *out++ = T();
+        }
+    }
+}
+
+// Packing space for gemm(): enough for any product of at most m x n x k.
+// Callers that multiply repeatedly, or from several threads, keep one of
+// these per thread instead of allocating on every call.
+template <typename T>
+struct GemmBuffers
+{
+    DenseStorage<T> packedA;
+    DenseStorage<T> packedB;
+
+    GemmBuffers(int m, int n, int k)
+        : packedA(1, std::min(GEMM_MC, m) * std::min(GEMM_KC, k) + GemmKernel<T>::MR * GEMM_KC),
+          packedB(1, std::min(GEMM_KC, k) * (std::min(GEMM_NC, n) + GemmKernel<T>::NR))
+    {
+    }
+};
+
+template <typename T>
+void gemm(int m, int n, int k, const T* a, int lda, const T* b, int ldb, T* c, int ldc, GemmBuffers<T>& buffers)
+{
+    const int MR = GemmKernel<T>::MR;
+    const int NR = GemmKernel<T>::NR;
+    T* packedA = buffers.packedA.getData();
+    T* packedB = buffers.packedB.getData();
+    for (int jc = 0; jc < n; jc += GEMM_NC)
+    {
+        int nc = std::min(GEMM_NC, n - jc);
+        for (int pc = 0; pc < k; pc += GEMM_KC)
+        {
+            int kc = std::min(GEMM_KC, k - pc);
+            packPanelsB(kc, nc, b + (size_t)pc * ldb + jc, ldb, packedB);
+            for (int ic = 0; ic < m; ic += GEMM_MC)
+            {
+                int mc = std::min(GEMM_MC, m - ic);
+                packPanelsA(mc, kc, a + (size_t)ic * lda + pc, lda, packedA);
+                for (int jr = 0; jr < nc; jr += NR)
+                {
+                    const T* panelB = packedB + (size_t)jr * kc;
+                    for (int ir = 0; ir < mc; ir += MR)
+                    {
+                        const T* panelA = packedA + (size_t)ir * kc;
+                        T* tileC = c + (size_t)(ic + ir) * ldc + jc + jr;
+                        GemmKernel<T>::run(kc, panelA, panelB, tileC, ldc, std::min(MR, mc - ir), std::min(NR, nc - jr));
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+void gemm(int m, int n, int k, const T* a, int lda, const T* b, int ldb, T* c, int ldc)
+{
+    GemmBuffers<T> buffers(m, n, k);
+    gemm(m, n, k, a, lda, b, ldb, c, ldc, buffers);
+}
+
+#endif
@@ -0,0 +1,442 @@
+/*
+Storage and I/O shared by all the programs: DenseStorage keeps a matrix in
+one 64-byte aligned row-major buffer (transposeBlock copies one out
+transposed), InputReader parses the whole of stdin at once and OutputWriter
+buffers everything written to stdout.
+*/
+
+#ifndef MATRIX_IO_H
+#define MATRIX_IO_H
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+
+// Non-owning views of one row / one column of a DenseStorage.
+template <typename T>
+struct RowView
+{
+    T* first;
+    int size;
+    T& operator[](int j) const { return first[j]; }
+    T* begin() const { return first; }
+    T* end() const { return first + size; }
+};
+
+template <typename T>
+struct ColumnView
+{
+    T* first;
+    int size;
+    int stride;
+    T& operator[](int i) const { return first[(size_t)i * stride]; }
+};
+
+// Zero-copy view of a transposed matrix: element (i, j) is source[j][i],
+// read straight from the source's row-major buffer rows `stride` apart.
+template <typename T>
+struct TransposedView
+{
+    const T* first;
+    int rows;
+    int cols;
+    int stride;
+    const T& operator()(int i, int j) const { return first[(size_t)j * stride + i]; }
+};
+
+// Process-wide DenseStorage counters; set MATRIX_ALLOC_STATS to have them
+// printed to stderr when the program exits. Atomic, since worker threads
+// may allocate too.
+struct StorageStats
+{
+    std::atomic<long long> allocations{0};
+    std::atomic<long long> copies{0};
+
+    ~StorageStats()
+    {
+        if (getenv("MATRIX_ALLOC_STATS"))
+        {
+            fprintf(stderr, "DenseStorage: %lld allocations, %lld copies\n", allocations.load(), copies.load());
+        }
+    }
+};
+
+inline StorageStats& storageStats()
+{
+    static StorageStats stats;
+    return stats;
+}
+
+// Dense row-major storage: all elements live in a single 64-byte aligned
+// buffer, every row is padded to `stride` elements so it starts on a cache line.
+template <typename T>
+class DenseStorage
+{
+private:
+    int rows;
+    int cols;
+    int stride;
+    T* data;
+    // set when data belongs to someone else (a file mapping); nothing is freed then
+    std::shared_ptr<void> owner;
+
+    void allocate(int r, int c)
+    {
+        rows = r;
+        cols = c;
+        stride = strideFor(c);
+        size_t bytes = (size_t)rows * stride * sizeof(T);
+        data = nullptr;
+        if (bytes != 0)
+        {
+            data = (T*)aligned_alloc(64, bytes);
+            storageStats().allocations++;
+        }
+    }
+
+    void release()
+    {
+        if (!owner) free(data);
+        owner.reset();
+        data = nullptr;
+    }
+public:
+    static int strideFor(int c)
+    {
+        const int lane = 64 / sizeof(T);
+        return (c + lane - 1) / lane * lane;
+    }
+
+    DenseStorage(int r = 0, int c = 0, T value = T())
+    {
+        allocate(r, c);
+        std::fill(data, data + (size_t)rows * stride, value);
+    }
+
+    // wraps r x c elements laid out with strideFor(c) that are kept alive by `owner`
+    DenseStorage(T* external, int r, int c, std::shared_ptr<void> owner)
+        : rows(r), cols(c), stride(strideFor(c)), data(external), owner(std::move(owner))
+    {
+    }
+
+    DenseStorage(const DenseStorage& other)
+    {
+        allocate(other.rows, other.cols);
+        std::copy(other.data, other.data + (size_t)rows * stride, data);
+        storageStats().copies++;
+    }
+
+    DenseStorage(DenseStorage&& other) noexcept
+        : rows(other.rows), cols(other.cols), stride(other.stride), data(other.data), owner(std::move(other.owner))
+    {
+        other.rows = 0;
+        other.cols = 0;
+        other.data = nullptr;
+    }
+
+    DenseStorage& operator=(const DenseStorage& other)
+    {
+        if (this != &other)
+        {
+            if (rows != other.rows || cols != other.cols)
+            {
+                release();
+                allocate(other.rows, other.cols);
+            }
+            std::copy(other.data, other.data + (size_t)rows * stride, data);
+            storageStats().copies++;
+        }
+        return *this;
+    }
+
+    DenseStorage& operator=(DenseStorage&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            rows = other.rows;
+            cols = other.cols;
+            stride = other.stride;
+            data = other.data;
+            owner = std::move(other.owner);
+            other.rows = 0;
+            other.cols = 0;
+            other.data = nullptr;
+        }
+        return *this;
+    }
+
+    ~DenseStorage()
+    {
+        release();
+    }
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    int getStride() const { return stride; }
+    bool empty() const { return rows == 0 || cols == 0; }
+    T* getData() { return data; }
+    const T* getData() const { return data; }
+
+    T* operator[](int i) { return data + (size_t)i * stride; }
+    const T* operator[](int i) const { return data + (size_t)i * stride; }
+
+    RowView<T> row(int i) { return {(*this)[i], cols}; }
+    RowView<const T> row(int i) const { return {(*this)[i], cols}; }
+    ColumnView<T> column(int j) { return {data + j, rows, stride}; }
+    ColumnView<const T> column(int j) const { return {data + j, rows, stride}; }
+
+    void swapRows(int q, int w)
+    {
+        std::swap_ranges((*this)[q], (*this)[q] + cols, (*this)[w]);
+    }
+};
+
+// Cache-oblivious transpose, dst (cols x rows) = src^T: the longer side is
+// halved until a block fits in L1, so neither the reads nor the strided
+// writes depend on a tuned tile size.
+template <typename T>
+void transposeBlock(int rows, int cols, const T* src, int lds, T* dst, int ldd)
+{
+    if (rows <= 32 && cols <= 32)
+    {
+        for (int i = 0; i < rows; i++)
+        {
+            for (int j = 0; j < cols; j++)
+            {
+                dst[(size_t)j * ldd + i] = src[(size_t)i * lds + j];
+            }
+        }
+    } else if (rows >= cols)
+    {
+        int h = rows / 2;
+        transposeBlock(h, cols, src, lds, dst, ldd);
+        transposeBlock(rows - h, cols, src + (size_t)h * lds, lds, dst + h, ldd);
+    } else
+    {
+        int h = cols / 2;
+        transposeBlock(rows, h, src, lds, dst, ldd);
+        transposeBlock(rows, cols - h, src + h, lds, dst + (size_t)h * ldd, ldd);
+    }
+}
+
+// Bulk stdin reader. The whole input is read once and numbers are parsed
+// with std::from_chars. Large matrix blocks are cut into line-aligned chunks
+// that are tokenised and parsed in parallel, straight into the destination.
+class InputReader
+{
+private:
+    static constexpr size_t PARALLEL_MIN_VALUES = 1 << 18;
+    std::vector<char> buffer;
+    size_t pos = 0;
+
+    static bool isSpace(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+    }
+
+    static const char* skipSpace(const char* p, const char* last)
+    {
+        while (p < last && isSpace(*p)) p++;
+        return p;
+    }
+
+    template <typename T>
+    static const char* parse(const char* p, const char* last, T& value)
+    {
+        if (p < last && *p == '+') p++;
+        std::from_chars_result result = std::from_chars(p, last, value);
+        if (result.ec != std::errc()) value = T();
+        p = result.ptr;
+        while (p < last && !isSpace(*p)) p++;
+        return p;
+    }
+
+    static size_t countTokens(const char* p, const char* last)
+    {
+        size_t count = 0;
+        bool inToken = false;
+        for (; p < last; p++)
+        {
+            bool space = isSpace(*p);
+            if (!space && !inToken) count++;
+            inToken = !space;
+        }
+        return count;
+    }
+
+    template <typename F>
+    static void runParallel(int workers, F task)
+    {
+        std::vector<std::thread> pool;
+        for (int w = 1; w < workers; w++) pool.emplace_back(task, w);
+        task(0);
+        for (std::thread& t : pool) t.join();
+    }
+public:
+    InputReader()
+    {
+        size_t got = 0;
+        buffer.resize(1 << 20);
+        while ((got += fread(buffer.data() + got, 1, buffer.size() - got, stdin)) == buffer.size())
+        {
+            buffer.resize(buffer.size() * 2);
+        }
+        buffer.resize(got);
+    }
+
+    // true while there is anything but whitespace left to read
+    bool hasMore()
+    {
+        const char* last = buffer.data() + buffer.size();
+        pos = skipSpace(buffer.data() + pos, last) - buffer.data();
+        return pos < buffer.size();
+    }
+
+    template <typename T>
+    InputReader& operator>>(T& value)
+    {
+        const char* last = buffer.data() + buffer.size();
+        const char* p = skipSpace(buffer.data() + pos, last);
+        p = parse(p, last, value);
+        pos = p - buffer.data();
+        return *this;
+    }
+
+    // reads rows x cols values into a row-major block whose rows are `stride` apart
+    template <typename T>
+    void readBlock(T* out, int rows, int cols, int stride)
+    {
+        size_t count = (size_t)rows * cols;
+        const char* first = buffer.data() + pos;
+        const char* last = buffer.data() + buffer.size();
+        int workers = std::min<size_t>(std::thread::hardware_concurrency(), (last - first) >> 20);
+        if (count < PARALLEL_MIN_VALUES || workers < 2)
+        {
+            for (int i = 0; i < rows; i++)
+            {
+                for (int j = 0; j < cols; j++)
+                {
+                    *this >> out[(size_t)i * stride + j];
+                }
+            }
+            return;
+        }
+        std::vector<const char*> bounds(workers + 1, last);
+        bounds[0] = first;
+        for (int w = 1; w < workers; w++)
+        {
+            const char* p = std::max(first + (last - first) * w / workers, bounds[w - 1]);
+            p = std::find(p, last, '\n');
+            bounds[w] = p == last ? last : p + 1;
+        }
+        std::vector<size_t> start(workers + 1, 0);
+        runParallel(workers, [&](int w) { start[w + 1] = countTokens(bounds[w], bounds[w + 1]); });
+        for (int w = 0; w < workers; w++) start[w + 1] += start[w];
+        std::vector<const char*> stop(bounds.begin(), bounds.end() - 1);
+        runParallel(workers, [&](int w)
+        {
+            const char* p = bounds[w];
+            for (size_t t = start[w]; t < count && t < start[w + 1]; t++)
+            {
+                p = parse(skipSpace(p, bounds[w + 1]), bounds[w + 1], out[t / cols * stride + t % cols]);
+            }
+            stop[w] = p;
+        });
+        int w = 0;
+        while (w + 1 < workers && start[w + 1] < count) w++;
+        pos = (start[w + 1] >= count ? stop[w] : last) - buffer.data();
+    }
+};
+
+inline InputReader& stdinReader()
+{
+    static InputReader reader;
+    return reader;
+}
+
+// Buffered stdout writer: numbers are formatted with std::to_chars into one
+// reusable buffer that is written out in large fwrite() calls.
+// Fixed{x, k} prints x exactly like `cout << fixed << setprecision(k) << x`.
+struct Fixed
+{
+    double value;
+    int digits;
+};
+
+class OutputWriter
+{
+private:
+    static constexpr size_t CAPACITY = 1 << 20;
+    static constexpr size_t MAX_NUMBER = 512;
+    std::vector<char> buffer;
+    size_t used = 0;
+
+    char* reserve()
+    {
+        if (used + MAX_NUMBER > buffer.size()) flush();
+        return buffer.data() + used;
+    }
+public:
+    OutputWriter() : buffer(CAPACITY) {}
+
+    ~OutputWriter()
+    {
+        flush();
+    }
+
+    void flush()
+    {
+        fwrite(buffer.data(), 1, used, stdout);
+        fflush(stdout);
+        used = 0;
+    }
+
+    OutputWriter& operator<<(char c)
+    {
+        *reserve() = c;
+        used++;
+        return *this;
+    }
+
+    OutputWriter& operator<<(const char* s)
+    {
+        for (size_t len = strlen(s); len > 0;)
+        {
+            size_t chunk = std::min(len, MAX_NUMBER);
+            memcpy(reserve(), s, chunk);
+            used += chunk;
+            s += chunk;
+            len -= chunk;
+        }
+        return *this;
+    }
+
+    OutputWriter& operator<<(int value)
+    {
+        char* p = reserve();
+        used = std::to_chars(p, p + MAX_NUMBER, value).ptr - buffer.data();
+        return *this;
+    }
+
+    OutputWriter& operator<<(Fixed f)
+    {
+        char* p = reserve();
+        used = std::to_chars(p, p + MAX_NUMBER, f.value, std::chars_format::fixed, f.digits).ptr - buffer.data();
+        return *this;
+    }
+};
+
+inline OutputWriter& stdoutWriter()
+{
+    static OutputWriter writer;
+    return writer;
+}
+
+#endif
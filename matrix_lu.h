@@ -0,0 +1,270 @@
+/*
+Tiled LU factorization with partial pivoting, run as a task graph on a
+thread pool; the tiles are updated through the GEMM engine.
+*/
+
+#ifndef MATRIX_LU_H
+#define MATRIX_LU_H
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include <algorithm>
+
+#include "matrix_io.h"
+#include "matrix_gemm.h"
+#include "matrix_threads.h"
+
+// LU factorization with partial pivoting, P * A = L * U. The pivot rule is
+// the one GaussianProcess uses (largest |a_ik| in the column, no swap on a
+// tie with the diagonal). L (unit lower) and U are packed into one n x n
+// buffer, so after one O(n^3) factorization every right-hand side costs
+// O(n^2) and the determinant and inverse need no further elimination.
+// The matrix is cut into BLOCK x BLOCK tiles and factored as a task graph:
+// panel(k) eliminates tile column k, trsm(k, j) brings tile column j up to
+// date with panel k's row swaps and solves its U tile, and update(i, j, k)
+// subtracts L_ik * U_kj from tile (i, j) through the GEMM kernel. Tiles of
+// the next column are prioritized, so panel(k + 1) starts while the rest
+// of step k's updates are still running (lookahead).
+class LUFactorization
+{
+private:
+    int n;
+    DenseStorage<double> lu;
+    std::vector<int> perm; // row i of P * A is row perm[i] of A
+    std::vector<int> pivots; // panel step k swapped rows k and pivots[k]
+    int swaps;
+    std::atomic<bool> singular; // set by the first pivot at or below the threshold
+    double threshold;
+    static constexpr int BLOCK = 64;
+
+    // applies P, L^-1 and U^-1 in place to an n x k block of right-hand sides
+    void substitute(DenseStorage<double>& x) const
+    {
+        int k = x.getCols();
+        for (int i = 0; i < n; i++)
+        {
+            double* xi = x[i];
+            for (int j = 0; j < i; j++)
+            {
+                double l = lu[i][j];
+                const double* xj = x[j];
+                for (int c = 0; c < k; c++) xi[c] -= l * xj[c];
+            }
+        }
+        for (int i = n - 1; i >= 0; i--)
+        {
+            double* xi = x[i];
+            for (int j = i + 1; j < n; j++)
+            {
+                double u = lu[i][j];
+                const double* xj = x[j];
+                for (int c = 0; c < k; c++) xi[c] -= u * xj[c];
+            }
+            double d = lu[i][i];
+            for (int c = 0; c < k; c++) xi[c] /= d;
+        }
+    }
+
+    // Unblocked elimination of the panel columns k0..k0+kb-1 over rows k0..n-1.
+    // Swaps are applied inside the panel only and recorded in pivots; the
+    // other tile columns pick them up in their own tasks.
+    void factorPanel(int k0, int kb)
+    {
+        for (int k = k0; k < k0 + kb; k++)
+        {
+            double mx = 0;
+            int pivot = k;
+            ColumnView<double> column = lu.column(k);
+            for (int i = k; i < n; i++)
+            {
+                if (std::abs(column[i]) > mx)
+                {
+                    mx = std::abs(column[i]);
+                    pivot = i;
+                }
+            }
+            if (pivot != k && mx != std::abs(lu[k][k]))
+            {
+                std::swap_ranges(lu[k] + k0, lu[k] + k0 + kb, lu[pivot] + k0);
+                std::swap(perm[pivot], perm[k]);
+                pivots[k] = pivot;
+                swaps++;
+            }
+            if (std::abs(lu[k][k]) <= threshold)
+            {
+                singular = true;
+                return;
+            }
+            const double* rowK = lu[k];
+            for (int i = k + 1; i < n; i++)
+            {
+                double* rowI = lu[i];
+                double l = rowI[k] / rowK[k];
+                rowI[k] = l;
+                if (l == 0) continue;
+                for (int j = k + 1; j < k0 + kb; j++) rowI[j] -= l * rowK[j];
+            }
+        }
+    }
+
+    // replays the swaps of panel rows k0..k0+kb-1 on columns c0..c1-1
+    void applyPivots(int k0, int kb, int c0, int c1)
+    {
+        for (int k = k0; k < k0 + kb; k++)
+        {
+            if (pivots[k] != k) std::swap_ranges(lu[k] + c0, lu[k] + c1, lu[pivots[k]] + c0);
+        }
+    }
+public:
+    // worker threads for the factorization; set from MATRIX_THREADS in main()
+    static inline int threads = std::max(1, (int)std::thread::hardware_concurrency());
+    // a pivot with |u_kk| <= tolerance * max|a_ij| counts as singular;
+    // set from MATRIX_SINGULAR_TOLERANCE in main()
+    static inline double tolerance = 0;
+
+    // Factors a, or stops at the first (near-)zero pivot: the tasks still
+    // queued then return at once and isSingular() reports the failure.
+    explicit LUFactorization(const DenseStorage<double>& a)
+        : n(a.getRows()), lu(a), perm(n), pivots(n), swaps(0), singular(false), threshold(0)
+    {
+        for (int i = 0; i < n; i++) perm[i] = pivots[i] = i;
+        if (tolerance > 0)
+        {
+            double scale = 0;
+            for (int i = 0; i < n; i++)
+            {
+                for (int j = 0; j < n; j++) scale = std::max(scale, std::abs(lu[i][j]));
+            }
+            threshold = tolerance * scale;
+        }
+        int tiles = (n + BLOCK - 1) / BLOCK;
+        auto width = [&](int t) { return std::min(BLOCK, n - t * BLOCK); };
+        // -L_ik tiles of each panel, the A operand of the updates, and one set
+        // of GEMM packing buffers per worker: nothing is allocated inside the graph
+        std::vector<DenseStorage<double>> minusL;
+        for (int k = 0; k < tiles; k++) minusL.emplace_back(n - k * BLOCK - width(k), width(k));
+        int workers = std::max(1, std::min(threads, tiles));
+        std::vector<GemmBuffers<double>> buffers;
+        for (int id = 0; id < workers; id++) buffers.emplace_back(BLOCK, BLOCK, BLOCK);
+
+        TaskGraph graph;
+        std::vector<int> panel(tiles);
+        std::vector<std::vector<int>> trsm(tiles, std::vector<int>(tiles));
+        std::vector<std::vector<int>> lastUpdate(tiles, std::vector<int>(tiles, -1)); // latest task writing tile (i, j)
+        for (int k = 0; k < tiles; k++)
+        {
+            int k0 = k * BLOCK, kb = width(k);
+            panel[k] = graph.add((long long)k * tiles + k, [this, &minusL, k0, kb, k](int)
+            {
+                if (singular) return;
+                factorPanel(k0, kb);
+                if (singular) return;
+                int below = n - k0 - kb;
+                for (int i = 0; i < below; i++)
+                {
+                    for (int p = 0; p < kb; p++) minusL[k][i][p] = -lu[k0 + kb + i][k0 + p];
+                }
+            });
+            for (int i = k; i < tiles; i++)
+            {
+                if (lastUpdate[i][k] >= 0) graph.depend(lastUpdate[i][k], panel[k]);
+            }
+            for (int j = k + 1; j < tiles; j++)
+            {
+                int c0 = j * BLOCK, c1 = c0 + width(j);
+                trsm[k][j] = graph.add((long long)j * tiles + k, [this, k0, kb, c0, c1](int)
+                {
+                    if (singular) return;
+                    applyPivots(k0, kb, c0, c1);
+                    // U_kj = L_kk^-1 * A_kj
+                    for (int i = k0 + 1; i < k0 + kb; i++)
+                    {
+                        for (int p = k0; p < i; p++)
+                        {
+                            double l = lu[i][p];
+                            const double* rowP = lu[p];
+                            double* rowI = lu[i];
+                            for (int c = c0; c < c1; c++) rowI[c] -= l * rowP[c];
+                        }
+                    }
+                });
+                graph.depend(panel[k], trsm[k][j]);
+                // the swaps touch every row of the column from k down
+                for (int i = k; i < tiles; i++)
+                {
+                    if (lastUpdate[i][j] >= 0) graph.depend(lastUpdate[i][j], trsm[k][j]);
+                }
+            }
+            for (int i = k + 1; i < tiles; i++)
+            {
+                for (int j = k + 1; j < tiles; j++)
+                {
+                    int r0 = i * BLOCK, c0 = j * BLOCK, rb = width(i), cb = width(j);
+                    int update = graph.add((long long)j * tiles + k, [this, &minusL, &buffers, k, k0, kb, r0, c0, rb, cb](int worker)
+                    {
+                        if (singular) return;
+                        const DenseStorage<double>& l = minusL[k];
+                        gemm(rb, cb, kb, l[r0 - k0 - kb], l.getStride(),
+                             lu[k0] + c0, lu.getStride(), lu[r0] + c0, lu.getStride(), buffers[worker]);
+                    });
+                    graph.depend(trsm[k][j], update);
+                    lastUpdate[i][j] = update;
+                }
+            }
+        }
+        graph.run(workers);
+        if (singular) return;
+
+        // the L part left of each panel still needs that panel's swaps
+        for (int k = 1; k < tiles; k++)
+        {
+            applyPivots(k * BLOCK, width(k), 0, k * BLOCK);
+        }
+    }
+
+    bool isSingular() const
+    {
+        return singular;
+    }
+
+    double determinant() const
+    {
+        if (singular) return 0;
+        double det = swaps % 2 == 0 ? 1 : -1;
+        for (int i = 0; i < n; i++) det *= lu[i][i];
+        return det;
+    }
+
+    std::vector<double> solve(const std::vector<double>& b) const
+    {
+        DenseStorage<double> x(n, 1);
+        for (int i = 0; i < n; i++) x[i][0] = b[perm[i]];
+        substitute(x);
+        std::vector<double> result(n);
+        for (int i = 0; i < n; i++) result[i] = x[i][0];
+        return result;
+    }
+
+    // solves A * X = B for an n x k block B
+    DenseStorage<double> solve(const DenseStorage<double>& b) const
+    {
+        DenseStorage<double> x(n, b.getCols());
+        for (int i = 0; i < n; i++)
+        {
+            std::copy(b[perm[i]], b[perm[i]] + b.getCols(), x[i]);
+        }
+        substitute(x);
+        return x;
+    }
+
+    DenseStorage<double> inverse() const
+    {
+        DenseStorage<double> identity(n, n);
+        for (int i = 0; i < n; i++) identity[i][i] = 1;
+        return solve(identity);
+    }
+};
+
+#endif
@@ -0,0 +1,428 @@
+/*
+Compressed sparse row matrices for the iterative solvers: triplet input,
+the Jacobi splitting, and the Gauss-Seidel, multicolor and SOR sweeps.
+*/
+
+#ifndef MATRIX_SPARSE_H
+#define MATRIX_SPARSE_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "matrix_io.h"
+
+// Compressed sparse row matrix: the non-zeros of row i are
+// values[rowPtr[i] .. rowPtr[i + 1]) in columns colIndex[...], sorted by
+// column. A product with a vector costs O(nnz) instead of O(n^2).
+class SparseMatrix
+{
+public:
+    int n;
+    std::vector<size_t> rowPtr;
+    std::vector<int> colIndex;
+    std::vector<double> values;
+
+    explicit SparseMatrix(int n = 0) : n(n), rowPtr(n + 1, 0)
+    {
+    }
+
+    // the non-zeros of a dense n x n block, row by row
+    static SparseMatrix fromDense(const DenseStorage<double>& a, int n)
+    {
+        SparseMatrix result(n);
+        for (int i = 0; i < n; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                if (a[i][j] != 0)
+                {
+                    result.colIndex.push_back(j);
+                    result.values.push_back(a[i][j]);
+                }
+            }
+            result.rowPtr[i + 1] = result.values.size();
+        }
+        return result;
+    }
+
+    // Reads nnz "i j value" triplets (1-based, any order) from stdin;
+    // repeated positions are summed and an index outside 1..n is an error.
+    static SparseMatrix input(int n, size_t nnz)
+    {
+        std::vector<int> rows(nnz), cols(nnz);
+        std::vector<double> vals(nnz);
+        SparseMatrix result(n);
+        for (size_t k = 0; k < nnz; k++)
+        {
+            stdinReader() >> rows[k] >> cols[k] >> vals[k];
+            if (rows[k] < 1 || rows[k] > n || cols[k] < 1 || cols[k] > n)
+            {
+                stdoutWriter() << "Error: the dimensional problem occurred" << '\n';
+                std::exit(0);
+            }
+            rows[k]--;
+            cols[k]--;
+            result.rowPtr[rows[k] + 1]++;
+        }
+        for (int i = 0; i < n; i++) result.rowPtr[i + 1] += result.rowPtr[i];
+        // bucket the triplets by row, then sort and merge each row
+        std::vector<size_t> next(result.rowPtr.begin(), result.rowPtr.end() - 1);
+        std::vector<std::pair<int, double>> entries(nnz);
+        for (size_t k = 0; k < nnz; k++) entries[next[rows[k]]++] = {cols[k], vals[k]};
+        result.colIndex.reserve(nnz);
+        result.values.reserve(nnz);
+        size_t first = 0;
+        for (int i = 0; i < n; i++)
+        {
+            size_t last = result.rowPtr[i + 1];
+            std::sort(entries.begin() + first, entries.begin() + last,
+                 [](const std::pair<int, double>& x, const std::pair<int, double>& y) { return x.first < y.first; });
+            result.rowPtr[i] = result.values.size();
+            for (size_t k = first; k < last; k++)
+            {
+                if (k > first && entries[k].first == entries[k - 1].first)
+                {
+                    result.values.back() += entries[k].second;
+                } else
+                {
+                    result.colIndex.push_back(entries[k].first);
+                    result.values.push_back(entries[k].second);
+                }
+            }
+            first = last;
+        }
+        result.rowPtr[n] = result.values.size();
+        return result;
+    }
+
+    double diagonal(int i) const
+    {
+        for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; k++)
+        {
+            if (colIndex[k] == i) return values[k];
+        }
+        return 0;
+    }
+
+    // Splits A x = b into x = alpha x + beta: alpha keeps A's pattern
+    // without the diagonal, αᵢⱼ = -аᵢⱼ / аᵢᵢ, and βᵢ = bᵢ / аᵢᵢ. Returns false
+    // when A is not strictly diagonally dominant.
+    bool jacobiSplit(const std::vector<double>& b, SparseMatrix& alpha, std::vector<double>& beta) const
+    {
+        alpha = SparseMatrix(n);
+        alpha.colIndex.reserve(values.size());
+        alpha.values.reserve(values.size());
+        beta.assign(n, 0);
+        for (int i = 0; i < n; i++)
+        {
+            double d = diagonal(i);
+            double sum = 0;
+            for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; k++)
+            {
+                if (colIndex[k] == i) continue;
+                sum += std::abs(values[k]);
+                alpha.colIndex.push_back(colIndex[k]);
+                alpha.values.push_back(-values[k] / d);
+            }
+            alpha.rowPtr[i + 1] = alpha.values.size();
+            if (sum >= std::abs(d)) return false;
+            beta[i] = b[i] / d;
+        }
+        return true;
+    }
+
+    // One Gauss-Seidel sweep of x = this * x + beta, in place over rows
+    // first..last-1: each row already sees the entries updated before it.
+    // Returns the squared norm of the change.
+    double seidelSweep(const double* beta, double* x, int first, int last) const
+    {
+        double change = 0;
+        for (int i = first; i < last; i++)
+        {
+            double sum = 0;
+            for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; k++)
+            {
+                sum += values[k] * x[colIndex[k]];
+            }
+            sum += beta[i];
+            change += (sum - x[i]) * (sum - x[i]);
+            x[i] = sum;
+        }
+        return change;
+    }
+
+    // The rows coupled with each row in either direction, the pattern plus
+    // its transpose: neighbours[start[i]..start[i+1]) for row i.
+    void couplings(std::vector<size_t>& start, std::vector<int>& neighbours) const
+    {
+        start.assign(n + 1, 0);
+        for (int i = 0; i < n; i++)
+        {
+            for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; k++)
+            {
+                start[i + 1]++;
+                start[colIndex[k] + 1]++;
+            }
+        }
+        for (int i = 0; i < n; i++) start[i + 1] += start[i];
+        neighbours.assign(start[n], 0);
+        std::vector<size_t> next(start.begin(), start.end() - 1);
+        for (int i = 0; i < n; i++)
+        {
+            for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; k++)
+            {
+                neighbours[next[i]++] = colIndex[k];
+                neighbours[next[colIndex[k]]++] = i;
+            }
+        }
+    }
+
+    // Whether the natural row order is consistently ordered: the rows can be
+    // given levels so that every coupling with a later row goes one level up
+    // and every coupling with an earlier row one level down. Young's optimal
+    // SOR factor holds only then; a stencil in row order qualifies, a dense
+    // matrix does not.
+    bool isConsistentlyOrdered() const
+    {
+        std::vector<size_t> start;
+        std::vector<int> neighbours;
+        couplings(start, neighbours);
+        std::vector<int> level(n);
+        std::vector<bool> seen(n, false);
+        std::vector<int> queue;
+        for (int root = 0; root < n; root++)
+        {
+            if (seen[root]) continue;
+            seen[root] = true;
+            level[root] = 0;
+            queue.assign(1, root);
+            for (size_t q = 0; q < queue.size(); q++)
+            {
+                int i = queue[q];
+                for (size_t k = start[i]; k < start[i + 1]; k++)
+                {
+                    int j = neighbours[k];
+                    if (j == i) continue;
+                    int expected = level[i] + (j > i ? 1 : -1);
+                    if (!seen[j])
+                    {
+                        seen[j] = true;
+                        level[j] = expected;
+                        queue.push_back(j);
+                    } else if (level[j] != expected)
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // Whether this matrix is S^-1 M S for a diagonal S and a symmetric M, so
+    // that its eigenvalues are real: every coupling must be mirrored with the
+    // same sign, and the scales s_j = s_i std::sqrt(a_ij / a_ji) that follow must
+    // agree around every cycle. They are kept as logarithms.
+    bool isSymmetrizable() const
+    {
+        std::vector<double> scale(n);
+        std::vector<bool> seen(n, false);
+        std::vector<int> queue;
+        for (int root = 0; root < n; root++)
+        {
+            if (seen[root]) continue;
+            seen[root] = true;
+            scale[root] = 0;
+            queue.assign(1, root);
+            for (size_t q = 0; q < queue.size(); q++)
+            {
+                int i = queue[q];
+                for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; k++)
+                {
+                    int j = colIndex[k];
+                    if (j == i) continue;
+                    auto first = colIndex.begin() + rowPtr[j], last = colIndex.begin() + rowPtr[j + 1];
+                    auto mirror = std::lower_bound(first, last, i);
+                    if (mirror == last || *mirror != i) return false;
+                    double back = values[mirror - colIndex.begin()];
+                    if (values[k] * back <= 0) return false;
+                    double expected = scale[i] + 0.5 * (std::log(std::abs(values[k])) - std::log(std::abs(back)));
+                    if (!seen[j])
+                    {
+                        seen[j] = true;
+                        scale[j] = expected;
+                        queue.push_back(j);
+                    } else if (std::abs(scale[j] - expected) > 1e-9 * std::max(1.0, std::abs(expected)))
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // Rows grouped into colors so that no two rows of one color are coupled
+    // (a_ij or a_ji non-zero); the rows of a color can then be swept in any
+    // order or all at once. A two-coloring is tried first, which is the
+    // red-black ordering of stencil matrices; when the coupling graph is not
+    // bipartite every row takes the smallest color no coloured neighbour has.
+    std::vector<std::vector<int>> colorClasses() const
+    {
+        std::vector<size_t> start;
+        std::vector<int> neighbours;
+        couplings(start, neighbours);
+
+        std::vector<int> color(n, -1);
+        bool bipartite = true;
+        std::vector<int> queue;
+        for (int root = 0; root < n && bipartite; root++)
+        {
+            if (color[root] >= 0) continue;
+            color[root] = 0;
+            queue.assign(1, root);
+            for (size_t q = 0; q < queue.size() && bipartite; q++)
+            {
+                int i = queue[q];
+                for (size_t k = start[i]; k < start[i + 1]; k++)
+                {
+                    int j = neighbours[k];
+                    if (j == i) continue;
+                    if (color[j] < 0)
+                    {
+                        color[j] = 1 - color[i];
+                        queue.push_back(j);
+                    } else if (color[j] == color[i])
+                    {
+                        bipartite = false;
+                        break;
+                    }
+                }
+            }
+        }
+        if (!bipartite)
+        {
+            std::fill(color.begin(), color.end(), -1);
+            std::vector<int> seen(n + 1, -1);
+            for (int i = 0; i < n; i++)
+            {
+                for (size_t k = start[i]; k < start[i + 1]; k++)
+                {
+                    int j = neighbours[k];
+                    if (color[j] >= 0) seen[color[j]] = i;
+                }
+                int c = 0;
+                while (seen[c] == i) c++;
+                color[i] = c;
+            }
+        }
+
+        std::vector<std::vector<int>> classes;
+        for (int i = 0; i < n; i++)
+        {
+            if (color[i] >= (int)classes.size()) classes.resize(color[i] + 1);
+            classes[color[i]].push_back(i);
+        }
+        return classes;
+    }
+
+    // the given rows as a matrix of their own (row r is row rows[r])
+    SparseMatrix rowsOf(const std::vector<int>& rows) const
+    {
+        SparseMatrix result(rows.size());
+        for (size_t r = 0; r < rows.size(); r++)
+        {
+            int i = rows[r];
+            result.colIndex.insert(result.colIndex.end(), colIndex.begin() + rowPtr[i], colIndex.begin() + rowPtr[i + 1]);
+            result.values.insert(result.values.end(), values.begin() + rowPtr[i], values.begin() + rowPtr[i + 1]);
+            result.rowPtr[r + 1] = result.values.size();
+        }
+        return result;
+    }
+
+    // Gauss-Seidel update of rows[first..last) of x, which must be mutually
+    // uncoupled, for a matrix built by rowsOf(rows). Returns the squared
+    // norm of the change.
+    double colorSweep(const std::vector<int>& rows, const double* beta, double* x, int first, int last) const
+    {
+        double change = 0;
+        for (int r = first; r < last; r++)
+        {
+            double sum = 0;
+            for (size_t k = rowPtr[r]; k < rowPtr[r + 1]; k++)
+            {
+                sum += values[k] * x[colIndex[k]];
+            }
+            int i = rows[r];
+            sum += beta[i];
+            change += (sum - x[i]) * (sum - x[i]);
+            x[i] = sum;
+        }
+        return change;
+    }
+
+    // One SOR sweep of x = this * x + beta: every row moves from x_i towards
+    // its Gauss-Seidel value by the factor omega (omega = 1 is seidelSweep).
+    // Rows go from first to last-1, or back from last-1 when reverse is set.
+    // Returns the squared norm of the change.
+    double sorSweep(const double* beta, double* x, double omega, int first, int last, bool reverse) const
+    {
+        double change = 0;
+        for (int r = first; r < last; r++)
+        {
+            int i = reverse ? first + last - 1 - r : r;
+            double sum = 0;
+            for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; k++)
+            {
+                sum += values[k] * x[colIndex[k]];
+            }
+            double step = omega * (sum + beta[i] - x[i]);
+            change += step * step;
+            x[i] += step;
+        }
+        return change;
+    }
+
+    // Spectral radius estimated by `steps` power-iteration steps from the
+    // all-ones vector. The steps go in pairs, since an iteration matrix of
+    // a red-black ordered system has both +rho and -rho as eigenvalues and
+    // the ratio of single steps would not settle.
+    double spectralRadius(int steps) const
+    {
+        std::vector<double> v(n, 1), y(n);
+        double radius = 0;
+        for (int s = 0; s + 1 < steps; s += 2)
+        {
+            double norm = 0;
+            for (double vi : v) norm += vi * vi;
+            norm = std::sqrt(norm);
+            if (norm == 0) return 0;
+            for (double& vi : v) vi /= norm;
+            multiply(v.data(), y.data(), 0, n);
+            multiply(y.data(), v.data(), 0, n);
+            double squared = 0;
+            for (double vi : v) squared += vi * vi;
+            radius = std::sqrt(std::sqrt(squared));
+        }
+        return radius;
+    }
+
+    // y = this * x for rows first..last-1
+    void multiply(const double* x, double* y, int first, int last) const
+    {
+        for (int i = first; i < last; i++)
+        {
+            double sum = 0;
+            for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; k++)
+            {
+                sum += values[k] * x[colIndex[k]];
+            }
+            y[i] = sum;
+        }
+    }
+};
+
+#endif
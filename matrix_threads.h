@@ -0,0 +1,116 @@
+/*
+Thread coordination shared by the parallel kernels: TaskGraph runs a
+dependency graph of tasks on a pool, SweepBarrier keeps a fixed group of
+workers in lockstep between sweeps.
+*/
+
+#ifndef MATRIX_THREADS_H
+#define MATRIX_THREADS_H
+
+#include <vector>
+#include <queue>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Dependency-driven task runner. Tasks are registered up front together
+// with their edges; a task becomes ready once everything it depends on has
+// finished, and among ready tasks the one with the smallest priority key
+// runs first. The calling thread works alongside threads - 1 helpers; each
+// task is told the id (0..threads-1) of the thread running it, so it can use
+// that thread's scratch space.
+class TaskGraph
+{
+private:
+    struct Task
+    {
+        std::function<void(int)> work;
+        std::vector<int> successors;
+        int waiting;
+        long long priority;
+    };
+    std::vector<Task> tasks;
+    std::priority_queue<std::pair<long long, int>, std::vector<std::pair<long long, int>>, std::greater<std::pair<long long, int>>> ready;
+    std::mutex lock;
+    std::condition_variable wake;
+    int remaining = 0;
+
+    void work(int id)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        while (true)
+        {
+            wake.wait(guard, [&] { return !ready.empty() || remaining == 0; });
+            if (remaining == 0) return;
+            int t = ready.top().second;
+            ready.pop();
+            guard.unlock();
+            tasks[t].work(id);
+            guard.lock();
+            remaining--;
+            for (int s : tasks[t].successors)
+            {
+                if (--tasks[s].waiting == 0) ready.push({tasks[s].priority, s});
+            }
+            wake.notify_all();
+        }
+    }
+public:
+    int add(long long priority, std::function<void(int)> work)
+    {
+        tasks.push_back({std::move(work), {}, 0, priority});
+        return tasks.size() - 1;
+    }
+
+    // `after` may not start before `before` has finished
+    void depend(int before, int after)
+    {
+        tasks[before].successors.push_back(after);
+        tasks[after].waiting++;
+    }
+
+    void run(int threads)
+    {
+        remaining = tasks.size();
+        for (int t = 0; t < (int)tasks.size(); t++)
+        {
+            if (tasks[t].waiting == 0) ready.push({tasks[t].priority, t});
+        }
+        std::vector<std::thread> pool;
+        for (int id = 1; id < threads; id++) pool.emplace_back([this, id] { work(id); });
+        work(0);
+        for (std::thread& t : pool) t.join();
+    }
+};
+
+// Barrier for a fixed group of threads that can be passed any number of times.
+class SweepBarrier
+{
+private:
+    std::mutex lock;
+    std::condition_variable wake;
+    int threads;
+    int waiting = 0;
+    long long generation = 0;
+public:
+    explicit SweepBarrier(int threads) : threads(threads)
+    {
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        long long current = generation;
+        if (++waiting == threads)
+        {
+            waiting = 0;
+            generation++;
+            wake.notify_all();
+            return;
+        }
+        wake.wait(guard, [&] { return generation != current; });
+    }
+};
+
+#endif
@@ -9,24 +9,25 @@ at each time step (t_i). The output prints arrays of time moments, victim counts
 and predator counts, all formatted with 2 decimal precision and space-separated.
 */
 
-#include <iostream>
 #include <vector>
-#include <iomanip>
 #include <cmath>
 
+#include "matrix_io.h"
+
 using namespace std;
+
 int main()
 {
     int numberOfVictims;
-    cin >> numberOfVictims;
+    stdinReader() >> numberOfVictims;
     int numberOfKillers;
-    cin >> numberOfKillers;
+    stdinReader() >> numberOfKillers;
     double alpha1, beta1, alpha2, beta2;
-    cin >> alpha1 >> beta1 >> alpha2 >> beta2;
+    stdinReader() >> alpha1 >> beta1 >> alpha2 >> beta2;
     double timeLimit;
-    cin >> timeLimit;
+    stdinReader() >> timeLimit;
     int numberOfThePoints;
-    cin >> numberOfThePoints;
+    stdinReader() >> numberOfThePoints;
     double v0 = numberOfVictims - alpha2 / beta2;
     double k0 = numberOfKillers - alpha1 / beta1;
     double t = 0;
@@ -48,27 +49,27 @@ int main()
     {
         if (in == 0)
         {
-            cout << "t:" << endl;
+            stdoutWriter() << "t:" << '\n';
         } else if (in == 1)
         {
-            cout << endl;
-            cout << "v:" << endl;
+            stdoutWriter() << '\n';
+            stdoutWriter() << "v:" << '\n';
         } else
         {
-            cout << endl;
-            cout << "k:" << endl;
+            stdoutWriter() << '\n';
+            stdoutWriter() << "k:" << '\n';
         }
         for (int j = 0; j <= numberOfThePoints; j++)
         {
             if (in == 0)
             {
-                cout << fixed << setprecision(2) << allT[j] << " ";
+                stdoutWriter() << Fixed{allT[j], 2} << " ";
             } else if (in == 1)
             {
-                cout << fixed << setprecision(2) << allV[j] << " ";
+                stdoutWriter() << Fixed{allV[j], 2} << " ";
             } else
             {
-                cout << fixed << setprecision(2) << allK[j] << " ";
+                stdoutWriter() << Fixed{allK[j], 2} << " ";
             }
         }
     }
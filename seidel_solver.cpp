@@ -8,23 +8,36 @@ the lower-triangular (B) and upper-triangular (C) decompositions, (I-B),
 and its inverse ((I-B)^{-1}). The program iteratively computes approximation vectors (x_i), 
 prints each step with its current accuracy (e), and finally outputs the approximate solution. 
 All numbers are formatted to four decimal places.
+The iterates come from the in-place forward sweep, which agrees with the
+(I-B)^{-1} formulation up to rounding in the last printed digit; with
+--sparse, A is read as CSR triplets and every sweep costs O(nnz); --multicolor sweeps the same
+input color by color, in parallel within each color; --sor and --ssor
+relax the sweep with an omega estimated and tuned at runtime.
 */
 
-#include <iostream>
 #include <vector>
-#include <iomanip>
 #include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
+#include <cstring>
+
+#include "matrix_io.h"
+#include "matrix_augmented.h"
+#include "matrix_threads.h"
+#include "matrix_sparse.h"
 
 using namespace std;
+
 class Matrix
 {
 public:
     int n;
-    vector<vector<double>> array;
+    DenseStorage<double> array;
     Matrix(int n)
     {
         this->n = n;
-        this->array = vector<vector<double>>(n, vector<double>(n));
+        this->array = DenseStorage<double>(n, n);
 
         // filling the vector with "empty" values (NaN)
         for (int i = 0; i < n; i++)
@@ -44,30 +57,7 @@ public:
 
     virtual void input()
     {
-        for (int i = 0; i < n; i++)
-        {
-            for (int j = 0; j < n; j++)
-            {
-                cin >> array[i][j];
-            }
-        }
-    }
-
-    void output(vector<vector<double>> tempArr)
-    {
-        for (int i = 0; i < n; i++)
-        {
-            for (int j = 0; j < n; j++)
-            {
-                cout << fixed << setprecision(4) << array[i][j] << " ";
-            }
-            for (int j = 0; j < n - 1; j++)
-            {
-                cout << fixed << setprecision(4) << tempArr[i][j] << " ";
-            }
-            cout << fixed << setprecision(4) << tempArr[i][n - 1];
-            cout << '\n';
-        }
+        stdinReader().readBlock(array.getData(), n, n, array.getStride());
     }
 
     void output()
@@ -78,126 +68,57 @@ public:
             {
                 if (!isnan(this->array[i][j]))
                 {
-                    cout << fixed << setprecision(4) << array[i][j] << " ";
+                    stdoutWriter() << Fixed{array[i][j], 4} << " ";
                 }
             }
             if (!isnan(this->array[i][n - 1]))
             {
-                cout << fixed << setprecision(4) << array[i][n - 1];
+                stdoutWriter() << Fixed{array[i][n - 1], 4};
             }
-            cout << '\n';
+            stdoutWriter() << '\n';
         }
     }
 
-    void operator=(const Matrix& ma)
+    Matrix(const Matrix& ma) = default;
+    Matrix(Matrix&& ma) = default;
+
+    Matrix& operator=(const Matrix& ma)
     {
         array = ma.array;
         n = ma.n;
+        return *this;
+    }
+
+    Matrix& operator=(Matrix&& ma)
+    {
+        array = std::move(ma.array);
+        n = ma.n;
+        return *this;
     }
 
     Matrix operator-(const Matrix& ma)
     {
-        vector<vector<double>> temp = vector<vector<double>>(n, vector<double>(n));
-        vector<vector<double>> a1 = ma.array;
+        Matrix Temporary(n);
         for (int i = 0; i < n; i++)
         {
             for (int j = 0; j < n; j++)
             {
-                temp[i][j] = array[i][j] - a1[i][j];
+                Temporary.array[i][j] = array[i][j] - ma.array[i][j];
             }
         }
-        Matrix Temporary(n);
-        Temporary.array = temp;
         return Temporary;
     }
 
-    vector<vector<double>> makePermutation(int q, int w, vector<vector<double>> tempArr)
-    {
-        if (q != w)
-        {
-            swap(tempArr[q], tempArr[w]);
-            swap(array[q], array[w]);
-        }
-        return tempArr;
-    }
-
-    vector<vector<double>> makeElimination(int col, vector<vector<double>> tempArr, bool flag)
-    {
-        if (flag)
-        {
-            for (int i = col+1; i < n; i++) // walk through the rows
-            {
-                double k = array[i][col] / array[col][col];
-                if (array[i][col] != 0)
-                {
-                    for (int j = 0; j < n; j++)
-                    {
-                        tempArr[i][j] -= k * tempArr[col][j];
-                        array[i][j] -= k * array[col][j];
-                    }
-                    step++;
-                }
-            }
-        } else {
-            for (int g = col - 1; g >= 0; g--) // walk through the rows
-            {
-                double k = array[g][col] / array[col][col];
-                if (array[g][col] != 0) {
-                    for (int j = n - 1; j >= 0; j--) {
-                        tempArr[g][j] -= k * tempArr[col][j];
-                        array[g][j] -= k * array[col][j];
-                    }
-                    step++;
-                }
-            }
-        }
-        return tempArr;
-    }
-
-    // array[i][j] - k * array[i-1][j]
-    // array[i][j] - k * array[i-1][j] = 0 => k = array[i][j] / array[i-1][j]
-    int step = 1;
-    vector<vector<double>> GaussianProcess(vector<vector<double>> tempArray)
-    {
-        int column = 0;
-        for (int count = 0; count < n; count++) { // counter for column detection
-            double mx = 0;
-            int temp = 0;
-            for (int i = count; i < n; i++) {
-                if (abs(array[i][column]) > mx) {
-                    mx = abs(array[i][column]);
-                    temp = i;
-                }
-            }
-            column += 1;
-            if (temp > 0 && abs(mx) != abs(array[count][count])) {
-                tempArray = makePermutation(temp, count, tempArray);
-                cout << "step #" << step << ": permutation" << endl;
-                output(tempArray);
-                step++;
-            }
-            tempArray = makeElimination(count, tempArray, true);
-        }
-        // reversed
-        for (int count = n - 1; count > 0; count--) { // counter for column detection
-            tempArray = makeElimination(count, tempArray, false);
-        }
-        return tempArray;
-    }
-
-    vector<vector<double>> diagonalNormalization(vector<vector<double>> tempArray)
+    Matrix& operator-=(const Matrix& ma)
     {
         for (int i = 0; i < n; i++)
         {
-            double k = array[i][i];
             for (int j = 0; j < n; j++)
             {
-                array[i][j] /= k;
-                tempArray[i][j] /= k;
+                array[i][j] -= ma.array[i][j];
             }
         }
-        array = tempArray;
-        return tempArray;
+        return *this;
     }
 
     void lowerTriangular()
@@ -228,30 +149,33 @@ public:
     {
         if (n == ma.n)
         {
-            vector<vector<double>> temp = vector<vector<double>>(n, vector<double>(ma.n, 0));
-            vector<vector<double>> a1 = ma.array;
+            Matrix Temporary(n);
             for (int i = 0; i < n; i++)
             {
-                for (int j = 0; j < ma.n; j++)
+                double* row = Temporary.array[i];
+                fill(row, row + ma.n, 0.0);
+                for (int c = 0; c < n; c++)
                 {
-                    for (int c = 0; c < n; c++)
+                    double k = array[i][c];
+                    const double* src = ma.array[c];
+                    for (int j = 0; j < ma.n; j++)
                     {
-                        temp[i][j] += array[i][c] * a1[c][j];
+                        row[j] += k * src[j];
                     }
                 }
             }
-            Matrix Temporary(n);
-            Temporary.array = temp;
             return Temporary;
         } else
         {
-            cout << "Error: the dimensional problem occurred" << endl;
-            vector<vector<double>> temp = vector<vector<double>>(0, vector<double>(0));
-            Matrix Temporary(0);
-            Temporary.array = temp;
-            return Temporary;
+            stdoutWriter() << "Error: the dimensional problem occurred" << '\n';
+            return Matrix(0);
         }
     }
+
+    Matrix& operator*=(const Matrix& ma)
+    {
+        return *this = *this * ma;
+    }
 };
 
 class IdentityMatrix : public Matrix
@@ -260,9 +184,9 @@ public:
     IdentityMatrix(int n) : Matrix(n)
     {
         this->n = n;
-        this->array = vector<vector<double>>(n, vector<double>(n, 0));
+        this->array = DenseStorage<double>(n, n, 0);
     }
-    vector<vector<double>> change()
+    DenseStorage<double>& change()
     {
         for (int i = 0; i < n; i++)
         {
@@ -277,27 +201,29 @@ class ColumnVector : public Matrix
 private:
     vector<double> vectorArr;
 public:
-    ColumnVector(int n) : Matrix(n)
+    // workers of the multicolor sweeps; set from MATRIX_THREADS in main()
+    static int threads;
+    static constexpr double OMEGA_MAX = 1.95;
+
+    ColumnVector(int n) : Matrix(0)
     {
+        this->n = n;
         this->vectorArr = vector<double>(n);
     }
 
     void input() override
     {
-        for (int i = 0; i < n; i++)
-        {
-            cin >> vectorArr[i];
-        }
+        stdinReader().readBlock(vectorArr.data(), 1, n, n);
     }
 
     void outputVector()
     {
         for (int j = 0; j < n - 1; j++)
         {
-            cout << fixed << setprecision(4) << vectorArr[j] << endl;
+            stdoutWriter() << Fixed{vectorArr[j], 4} << '\n';
         }
-        cout << fixed << setprecision(4) << vectorArr[n - 1];
-        cout << '\n';
+        stdoutWriter() << Fixed{vectorArr[n - 1], 4};
+        stdoutWriter() << '\n';
     }
 
     ColumnVector operator-(const ColumnVector& vector) {
@@ -314,6 +240,16 @@ public:
         return result;
     }
 
+    ColumnVector& operator+=(const ColumnVector& vector) {
+        for (int i = 0; i < n; i++) vectorArr[i] += vector.vectorArr[i];
+        return *this;
+    }
+
+    ColumnVector& operator-=(const ColumnVector& vector) {
+        for (int i = 0; i < n; i++) vectorArr[i] -= vector.vectorArr[i];
+        return *this;
+    }
+
     ColumnVector operator*(const Matrix& matrix)
     {
         ColumnVector result(n);
@@ -339,8 +275,8 @@ public:
 
     void SeidelMethod(const Matrix& A, double e) {
         int size = A.n;
-        vector<vector<double>> array;
-        vector<vector<double>> a = A.array;
+        DenseStorage<double> array;
+        const DenseStorage<double>& a = A.array;
         vector<double> b = vectorArr;
         vector<double> beta = vector<double>(size, 0);
         // Let's express from all the rows the xᵢ:
@@ -351,12 +287,12 @@ public:
                 if (i != j) sum += abs(a[i][j]);
             }
             if (sum >= abs(a[i][i])) {
-                cout << "The method is not applicable";
+                stdoutWriter() << "The method is not applicable";
                 exit(0);
             }
         }
         // αᵢⱼ = -аᵢⱼ / аᵢᵢ
-        vector<vector<double>> alpha = vector<vector<double>>(size, vector<double>(size, 0));
+        DenseStorage<double> alpha = DenseStorage<double>(size, size, 0);
         for (int i = 0; i < size; i++) {
             for (int j = 0; j < size; j++) {
                 if (i != j) alpha[i][j] = -a[i][j] / a[i][i];
@@ -366,67 +302,272 @@ public:
         ColumnVector xARRAY1(n);
         ColumnVector xARRAY2(n);
         Matrix MatrixALPHA(n);
-        MatrixALPHA.array = alpha;
-        cout << "alpha:" << endl;
+        MatrixALPHA.array = std::move(alpha);
+        stdoutWriter() << "alpha:" << '\n';
         MatrixALPHA.output();
         ColumnVector VectorBETA(n);
         VectorBETA.vectorArr = beta;
-        cout << "beta:" << endl;
+        stdoutWriter() << "beta:" << '\n';
         VectorBETA.outputVector();
 
         Matrix B(n);
         B = MatrixALPHA;
-        cout << "B:" << endl;
+        stdoutWriter() << "B:" << '\n';
         B.lowerTriangular();
         Matrix C(n);
         C = MatrixALPHA;
-        cout << "C:" << endl;
+        stdoutWriter() << "C:" << '\n';
         C.upperTriangular();
 
         IdentityMatrix I(n);
         I.change();
-        cout << "I-B:" << endl;
+        stdoutWriter() << "I-B:" << '\n';
         Matrix IB = I - B;
         IB.output();
-        cout << "(I-B)_-1:" << endl;
-        IB.diagonalNormalization(IB.GaussianProcess(I.array));
+        stdoutWriter() << "(I-B)_-1:" << '\n';
+        AugmentedMatrix augmented(IB.array, I.array, 4, AugmentedMatrix::TRACE_PERMUTATIONS);
+        augmented.GaussianProcess();
+        augmented.diagonalNormalization();
+        IB.array = augmented.right();
         IB.output();
 
+        // The iteration itself is the in-place sweep x_i = beta_i + sum_j alpha_ij x_j
+        // over the non-zeros of alpha, which is the same x(k+1) = (I-B)^-1 (C x(k) + beta)
+        // without any inverse or matrix product; (I-B)^-1 above is only shown.
+        // The sweep rounds differently from the product form, so a printed value
+        // can differ from it in the last (fourth) decimal, and an e right at the
+        // threshold can end the loop one sweep earlier or later.
+        SparseMatrix SparseALPHA = SparseMatrix::fromDense(MatrixALPHA.array, n);
         xARRAY1.vectorArr = beta;
         int k = 1;
-        Matrix IBC = IB * C;
-        xARRAY2 = xARRAY1 * IBC + VectorBETA * IB;
+        xARRAY2.vectorArr = beta;
+        SparseALPHA.seidelSweep(beta.data(), xARRAY2.vectorArr.data(), 0, n);
         ColumnVector Answer(n);
         Answer.vectorArr = xARRAY2.vectorArr;
         double ex = xARRAY2.condition(xARRAY1);
         while (ex > e) {
-            cout << "x(" << k << ")" << endl;
+            stdoutWriter() << "x(" << k << ")" << '\n';
             k += 1;
             xARRAY2.outputVector();
             ex = xARRAY2.condition(xARRAY1);
-            cout << "e: " << fixed << setprecision(4) << ex << endl;
+            stdoutWriter() << "e: " << Fixed{ex, 4} << '\n';
             Answer.vectorArr = xARRAY2.vectorArr;
             xARRAY1.vectorArr = xARRAY2.vectorArr;
-            IBC = IB * C;
-            xARRAY2 = xARRAY1 * IBC + VectorBETA * IB;
+            SparseALPHA.seidelSweep(beta.data(), xARRAY2.vectorArr.data(), 0, n);
+        }
+        stdoutWriter() << "x~:" << '\n';
+        Answer.outputVector();
+    }
+
+    // Gauss-Seidel on a sparse A: every sweep is O(nnz) and works in place
+    // on one iterate. Only e of each sweep and x~ are printed.
+    void SparseSeidelMethod(const SparseMatrix& A, double e) {
+        SparseMatrix alpha;
+        vector<double> beta;
+        if (!A.jacobiSplit(vectorArr, alpha, beta)) {
+            stdoutWriter() << "The method is not applicable";
+            exit(0);
+        }
+        vector<double> x = beta;
+        double ex;
+        do {
+            ex = sqrt(alpha.seidelSweep(beta.data(), x.data(), 0, A.n));
+            stdoutWriter() << "e: " << Fixed{ex, 4} << '\n';
+        } while (ex > e);
+        stdoutWriter() << "x~:" << '\n';
+        ColumnVector Answer(A.n);
+        Answer.vectorArr = std::move(x);
+        Answer.outputVector();
+    }
+
+    // Multicolor Gauss-Seidel: a sweep updates the colors one after another
+    // and the rows of one color, which never read each other, in parallel
+    // on `threads` workers that live for the whole solve. Each color's rows
+    // sit in their own compact matrix so a worker streams through its range.
+    // A barrier closes every color; e is ||x(k+1) - x(k)|| over the whole
+    // sweep, exactly as for the sequential method.
+    void MulticolorSeidelMethod(const SparseMatrix& A, double e) {
+        SparseMatrix alpha;
+        vector<double> beta;
+        if (!A.jacobiSplit(vectorArr, alpha, beta)) {
+            stdoutWriter() << "The method is not applicable";
+            exit(0);
         }
-        cout << "x~:" << endl;
+        vector<vector<int>> classes = alpha.colorClasses();
+        vector<SparseMatrix> parts;
+        for (const vector<int>& rows : classes) parts.push_back(alpha.rowsOf(rows));
+
+        int workers = max(1, min(threads, A.n));
+        vector<double> x = beta;
+        vector<double> shares[2] = {vector<double>(workers), vector<double>(workers)};
+        SweepBarrier barrier(workers);
+        auto worker = [&](int t) {
+            for (int k = 0; ; k++) {
+                double change = 0;
+                for (size_t c = 0; c < classes.size(); c++) {
+                    int size = classes[c].size();
+                    int first = (long long)size * t / workers, last = (long long)size * (t + 1) / workers;
+                    change += parts[c].colorSweep(classes[c], beta.data(), x.data(), first, last);
+                    if (c + 1 < classes.size()) barrier.wait();
+                }
+                shares[k % 2][t] = change;
+                barrier.wait();
+                double ex = 0;
+                for (double share : shares[k % 2]) ex += share;
+                ex = sqrt(ex);
+                if (t == 0) stdoutWriter() << "e: " << Fixed{ex, 4} << '\n';
+                if (!(ex > e)) return;
+            }
+        };
+        vector<thread> pool;
+        for (int t = 1; t < workers; t++) pool.emplace_back(worker, t);
+        worker(0);
+        for (thread& t : pool) t.join();
+
+        stdoutWriter() << "x~:" << '\n';
+        ColumnVector Answer(A.n);
+        Answer.vectorArr = std::move(x);
+        Answer.outputVector();
+    }
+
+    // SOR, or with symmetric SSOR (a forward and then a backward sweep), with
+    // the relaxation factor picked at runtime. Twenty power-iteration steps
+    // on alpha give its spectral radius rho. SSOR takes
+    // omega = 2 / (1 + sqrt(2 (1 - rho))); SOR takes Young's optimum
+    // omega = 2 / (1 + sqrt(1 - rho²)) when A is consistently ordered and
+    // alpha has real eigenvalues, and plain Gauss-Seidel (omega = 1)
+    // otherwise. Omega stays below OMEGA_MAX, and drops back to 1 for good
+    // if the changes stop shrinking.
+    // A short power iteration tends to underestimate rho, so SOR keeps
+    // correcting omega once the ratio lambda of successive changes settles:
+    // lambda clearly above omega - 1 means omega is still short of the
+    // optimum, and rho² = (lambda + omega - 1)² / (lambda omega²) gives the
+    // next one. If lambda settles higher after a change, the previous omega
+    // is restored and kept. e is ||x(k+1) - x(k)|| as before; every omega in
+    // use is printed as "w:".
+    void SORMethod(const SparseMatrix& A, double e, bool symmetric) {
+        SparseMatrix alpha;
+        vector<double> beta;
+        if (!A.jacobiSplit(vectorArr, alpha, beta)) {
+            stdoutWriter() << "The method is not applicable";
+            exit(0);
+        }
+        bool tuning = !symmetric && A.isConsistentlyOrdered() && alpha.isSymmetrizable();
+        double rho = alpha.spectralRadius(20);
+        double omega = 1;
+        if (rho < 1 && (symmetric || tuning)) {
+            omega = symmetric ? 2 / (1 + sqrt(2 * (1 - rho))) : 2 / (1 + sqrt(1 - rho * rho));
+            omega = min(omega, OMEGA_MAX);
+        }
+        stdoutWriter() << "w: " << Fixed{omega, 4} << '\n';
+
+        vector<double> x = beta, start;
+        double ex, previous = 0, ratio = 0;
+        // settled ratio and omega from before the last change, to undo it
+        double before = 0, lastOmega = omega;
+        bool checking = false;
+        int settled = 0;
+        do {
+            double change = 0;
+            if (symmetric) {
+                // e spans both half-sweeps, not just the backward one
+                start = x;
+                alpha.sorSweep(beta.data(), x.data(), omega, 0, A.n, false);
+                alpha.sorSweep(beta.data(), x.data(), omega, 0, A.n, true);
+                for (int i = 0; i < A.n; i++) change += (x[i] - start[i]) * (x[i] - start[i]);
+            } else {
+                change = alpha.sorSweep(beta.data(), x.data(), omega, 0, A.n, false);
+            }
+            ex = sqrt(change);
+            stdoutWriter() << "e: " << Fixed{ex, 4} << '\n';
+            if (tuning && previous > 0) {
+                double lambda = ex / previous;
+                settled = abs(lambda - ratio) < 0.01 * lambda ? settled + 1 : 0;
+                ratio = lambda;
+                if (settled >= 3) {
+                    bool worse = checking && lambda > before;
+                    checking = false;
+                    if (lambda >= 1) {
+                        omega = 1;
+                        tuning = false;
+                        stdoutWriter() << "w: " << Fixed{omega, 4} << '\n';
+                    } else if (worse) {
+                        omega = lastOmega;
+                        tuning = false;
+                        stdoutWriter() << "w: " << Fixed{omega, 4} << '\n';
+                    } else if (lambda < 1 && lambda > pow(omega - 1, 0.75)) {
+                        // past the optimum lambda stays near omega - 1, so the
+                        // margin keeps noise from pushing omega further up
+                        double rho2 = (lambda + omega - 1) * (lambda + omega - 1) / (lambda * omega * omega);
+                        double tuned = rho2 < 1 ? min(2 / (1 + sqrt(1 - rho2)), OMEGA_MAX) : OMEGA_MAX;
+                        if (tuned > omega + 1e-3) {
+                            before = lambda;
+                            lastOmega = omega;
+                            omega = tuned;
+                            checking = true;
+                            settled = 0;
+                            stdoutWriter() << "w: " << Fixed{omega, 4} << '\n';
+                        }
+                    }
+                }
+            }
+            previous = ex;
+        } while (ex > e);
+        stdoutWriter() << "x~:" << '\n';
+        ColumnVector Answer(A.n);
+        Answer.vectorArr = std::move(x);
         Answer.outputVector();
     }
 };
 
-int main()
+int ColumnVector::threads = max(1, (int)thread::hardware_concurrency());
+
+int main(int argc, char* argv[])
 {
+    if (getenv("MATRIX_THREADS"))
+    {
+        ColumnVector::threads = max(1, atoi(getenv("MATRIX_THREADS")));
+    }
+
+    // seidel_solver --sparse: "n nnz", nnz "i j a_ij" triplets (1-based),
+    // then b and e as usual; --multicolor takes the same input and runs the
+    // parallel multicolor sweep, --sor and --ssor the relaxed sweeps
+    bool multicolor = argc > 1 && strcmp(argv[1], "--multicolor") == 0;
+    bool sor = argc > 1 && strcmp(argv[1], "--sor") == 0;
+    bool ssor = argc > 1 && strcmp(argv[1], "--ssor") == 0;
+    if (argc > 1 && (strcmp(argv[1], "--sparse") == 0 || multicolor || sor || ssor))
+    {
+        int n;
+        size_t nnz;
+        stdinReader() >> n >> nnz;
+        SparseMatrix A = SparseMatrix::input(n, nnz);
+        int m;
+        stdinReader() >> m;
+        if (m != n)
+        {
+            stdoutWriter() << "Error: the dimensional problem occurred" << '\n';
+            return 0;
+        }
+        ColumnVector b(m);
+        b.input();
+        double e;
+        stdinReader() >> e;
+        if (multicolor) b.MulticolorSeidelMethod(A, e);
+        else if (sor || ssor) b.SORMethod(A, e, ssor);
+        else b.SparseSeidelMethod(A, e);
+        return 0;
+    }
+
     int n;
-    cin >> n;
+    stdinReader() >> n;
     Matrix A(n);
     A.input();
     int m;
-    cin >> m;
+    stdinReader() >> m;
     ColumnVector b(m);
     b.input();
     double e;
-    cin >> e;
+    stdinReader() >> e;
     b.SeidelMethod(A, e);
     return 0;
 }
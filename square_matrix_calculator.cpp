@@ -6,58 +6,196 @@ and downcasting with pointers. If matrix sizes are incompatible,
 it prints “Error: the dimensional problem occurred.”
 */
 
-#include <iostream>
-#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+#include "matrix_io.h"
+#include "matrix_gemm.h"
 
 using namespace std;
-class Matrix
+
+// swaps a (rows x cols) with the transpose of b (cols x rows), recursively
+template <typename T>
+void swapTransposed(int rows, int cols, T* a, T* b, int ld)
 {
-private:
-    int n;
-    vector<vector<int>> array;
-public:
-    Matrix(int n)
+    if (rows <= 32 && cols <= 32)
     {
-        this->n = n;
-        this->array = vector<vector<int>>(n, vector<int>(n));
+        for (int i = 0; i < rows; i++)
+        {
+            for (int j = 0; j < cols; j++)
+            {
+                swap(a[(size_t)i * ld + j], b[(size_t)j * ld + i]);
+            }
+        }
+    } else if (rows >= cols)
+    {
+        int h = rows / 2;
+        swapTransposed(h, cols, a, b, ld);
+        swapTransposed(rows - h, cols, a + (size_t)h * ld, b + h, ld);
+    } else
+    {
+        int h = cols / 2;
+        swapTransposed(rows, h, a, b, ld);
+        swapTransposed(rows, cols - h, a + h, b + (size_t)h * ld, ld);
     }
+}
 
-    void input()
+// in-place transpose of an n x n block: the diagonal quadrants are
+// transposed recursively, the off-diagonal pair is swap-transposed
+template <typename T>
+void transposeSquareInPlace(int n, T* a, int ld)
+{
+    if (n <= 32)
     {
         for (int i = 0; i < n; i++)
         {
-            for (int j = 0; j < n; j++)
+            for (int j = i + 1; j < n; j++)
             {
-                cin >> array[i][j];
+                swap(a[(size_t)i * ld + j], a[(size_t)j * ld + i]);
             }
         }
+        return;
     }
+    int h = n / 2;
+    transposeSquareInPlace(h, a, ld);
+    transposeSquareInPlace(n - h, a + (size_t)h * ld + h, ld);
+    swapTransposed(h, n - h, a + h, a + (size_t)h * ld, ld);
+}
 
-    Matrix transposed()
+// z = x + sign * y over an h x h block; z may alias x or y
+template <typename T>
+void addBlocks(int h, const T* x, int ldx, const T* y, int ldy, T* z, int ldz, int sign)
+{
+    for (int i = 0; i < h; i++)
+    {
+        const T* xi = x + (size_t)i * ldx;
+        const T* yi = y + (size_t)i * ldy;
+        T* zi = z + (size_t)i * ldz;
+        for (int j = 0; j < h; j++)
+        {
+            zi[j] = sign > 0 ? xi[j] + yi[j] : xi[j] - yi[j];
+        }
+    }
+}
+
+// C = A * B for n x n blocks using the Strassen-Winograd recursion
+// (7 products, 15 additions, two h x h scratch blocks per level).
+// Odd sizes are padded by one zero row/column; blocks of at most
+// `crossover` are handed to the blocked gemm() kernel.
+template <typename T>
+void strassenWinograd(int n, const T* a, int lda, const T* b, int ldb, T* c, int ldc, int crossover)
+{
+    if (n <= max(crossover, 1))
     {
-        vector<vector<int>> temp = vector<vector<int>>(n, vector<int>(n));
         for (int i = 0; i < n; i++)
         {
-            for (int j = 0; j < n; j++)
-            {
-                temp[j][i] = array[i][j];
-            }
+            fill(c + (size_t)i * ldc, c + (size_t)i * ldc + n, T());
+        }
+        gemm(n, n, n, a, lda, b, ldb, c, ldc);
+        return;
+    }
+    if (n % 2 != 0)
+    {
+        DenseStorage<T> pa(n + 1, n + 1), pb(n + 1, n + 1), pc(n + 1, n + 1);
+        for (int i = 0; i < n; i++)
+        {
+            copy(a + (size_t)i * lda, a + (size_t)i * lda + n, pa[i]);
+            copy(b + (size_t)i * ldb, b + (size_t)i * ldb + n, pb[i]);
+        }
+        strassenWinograd(n + 1, pa.getData(), pa.getStride(), pb.getData(), pb.getStride(),
+                         pc.getData(), pc.getStride(), crossover);
+        for (int i = 0; i < n; i++)
+        {
+            copy(pc[i], pc[i] + n, c + (size_t)i * ldc);
         }
+        return;
+    }
+    int h = n / 2;
+    const T* a11 = a;
+    const T* a12 = a + h;
+    const T* a21 = a + (size_t)h * lda;
+    const T* a22 = a21 + h;
+    const T* b11 = b;
+    const T* b12 = b + h;
+    const T* b21 = b + (size_t)h * ldb;
+    const T* b22 = b21 + h;
+    T* c11 = c;
+    T* c12 = c + h;
+    T* c21 = c + (size_t)h * ldc;
+    T* c22 = c21 + h;
+    DenseStorage<T> xs(h, h), ys(h, h);
+    T* x = xs.getData();
+    T* y = ys.getData();
+    int ldx = xs.getStride();
+    int ldy = ys.getStride();
+
+    addBlocks(h, a11, lda, a21, lda, x, ldx, -1);                  // S3 = A11 - A21
+    addBlocks(h, b22, ldb, b12, ldb, y, ldy, -1);                  // T3 = B22 - B12
+    strassenWinograd(h, x, ldx, y, ldy, c21, ldc, crossover);      // M7 = S3 * T3
+    addBlocks(h, a21, lda, a22, lda, x, ldx, 1);                   // S1 = A21 + A22
+    addBlocks(h, b12, ldb, b11, ldb, y, ldy, -1);                  // T1 = B12 - B11
+    strassenWinograd(h, x, ldx, y, ldy, c22, ldc, crossover);      // M5 = S1 * T1
+    addBlocks(h, x, ldx, a11, lda, x, ldx, -1);                    // S2 = S1 - A11
+    addBlocks(h, b22, ldb, y, ldy, y, ldy, -1);                    // T2 = B22 - T1
+    strassenWinograd(h, x, ldx, y, ldy, c12, ldc, crossover);      // M6 = S2 * T2
+    addBlocks(h, a12, lda, x, ldx, x, ldx, -1);                    // S4 = A12 - S2
+    strassenWinograd(h, x, ldx, b22, ldb, c11, ldc, crossover);    // M3 = S4 * B22
+    strassenWinograd(h, a11, lda, b11, ldb, x, ldx, crossover);    // M1 = A11 * B11
+    addBlocks(h, x, ldx, c12, ldc, c12, ldc, 1);                   // U2 = M1 + M6
+    addBlocks(h, c12, ldc, c21, ldc, c21, ldc, 1);                 // U3 = U2 + M7
+    addBlocks(h, c12, ldc, c22, ldc, c12, ldc, 1);                 // U4 = U2 + M5
+    addBlocks(h, c21, ldc, c22, ldc, c22, ldc, 1);                 // C22 = U3 + M5
+    addBlocks(h, c12, ldc, c11, ldc, c12, ldc, 1);                 // C12 = U4 + M3
+    addBlocks(h, y, ldy, b21, ldb, y, ldy, -1);                    // T4 = T2 - B21
+    strassenWinograd(h, a22, lda, y, ldy, c11, ldc, crossover);    // M4 = A22 * T4
+    addBlocks(h, c21, ldc, c11, ldc, c21, ldc, -1);                // C21 = U3 - M4
+    strassenWinograd(h, a12, lda, b21, ldb, c11, ldc, crossover);  // M2 = A12 * B21
+    addBlocks(h, x, ldx, c11, ldc, c11, ldc, 1);                   // C11 = M1 + M2
+}
+
+class Matrix
+{
+private:
+    int n;
+    DenseStorage<int> array;
+public:
+    // operator* switches to Strassen-Winograd above this size;
+    // set from MATRIX_STRASSEN_CROSSOVER in main()
+    static int strassenCrossover;
+
+    Matrix(int n)
+    {
+        this->n = n;
+        this->array = DenseStorage<int>(n, n);
+    }
+
+    void input()
+    {
+        stdinReader().readBlock(array.getData(), n, n, array.getStride());
+    }
+
+    Matrix transposed()
+    {
         Matrix ma(n);
-        ma.array = temp;
+        transposeBlock(n, n, array.getData(), array.getStride(), ma.array.getData(), ma.array.getStride());
         return ma;
     }
 
+    void transpose()
+    {
+        transposeSquareInPlace(n, array.getData(), array.getStride());
+    }
+
     void output()
     {
         for (int i = 0; i < n; i++)
         {
             for (int j = 0; j < n - 1; j++)
             {
-                cout << array[i][j] << " ";
+                stdoutWriter() << array[i][j] << " ";
             }
-            cout << array[i][n - 1];
-            cout << '\n';
+            stdoutWriter() << array[i][n - 1];
+            stdoutWriter() << '\n';
         }
     }
 
@@ -65,24 +203,18 @@ public:
     {
         if (ma.n != n)
         {
-            cout << "Error: the dimensional problem occurred" << endl;
-            vector<vector<int>> temp = vector<vector<int>>(0, vector<int>(0));
-            Matrix Temporary(0);
-            Temporary.array = temp;
-            return Temporary;
+            stdoutWriter() << "Error: the dimensional problem occurred" << '\n';
+            return Matrix(0);
         } else
         {
-            vector<vector<int>> temp = vector<vector<int>>(n, vector<int>(n));
-            vector<vector<int>> a1 = ma.array;
+            Matrix Temporary(n);
             for (int i = 0; i < n; i++)
             {
                 for (int j = 0; j < n; j++)
                 {
-                    temp[i][j] = array[i][j] + a1[i][j];
+                    Temporary.array[i][j] = array[i][j] + ma.array[i][j];
                 }
             }
-            Matrix Temporary(n);
-            Temporary.array = temp;
             return Temporary;
         }
     }
@@ -91,74 +223,119 @@ public:
     {
         if (ma.n != n)
         {
-            cout << "Error: the dimensional problem occurred" << endl;
-            vector<vector<int>> temp = vector<vector<int>>(0, vector<int>(0));
-            Matrix Temporary(0);
-            Temporary.array = temp;
-            return Temporary;
+            stdoutWriter() << "Error: the dimensional problem occurred" << '\n';
+            return Matrix(0);
         } else
         {
-            vector<vector<int>> temp = vector<vector<int>>(n, vector<int>(n));
-            vector<vector<int>> a1 = ma.array;
+            Matrix Temporary(n);
             for (int i = 0; i < n; i++)
             {
                 for (int j = 0; j < n; j++)
                 {
-                    temp[i][j] = array[i][j] - a1[i][j];
+                    Temporary.array[i][j] = array[i][j] - ma.array[i][j];
                 }
             }
-            Matrix Temporary(n);
-            Temporary.array = temp;
             return Temporary;
         }
     }
 
+    Matrix& operator+=(const Matrix& ma)
+    {
+        if (ma.n != n)
+        {
+            stdoutWriter() << "Error: the dimensional problem occurred" << '\n';
+            return *this = Matrix(0);
+        }
+        for (int i = 0; i < n; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                array[i][j] += ma.array[i][j];
+            }
+        }
+        return *this;
+    }
+
+    Matrix& operator-=(const Matrix& ma)
+    {
+        if (ma.n != n)
+        {
+            stdoutWriter() << "Error: the dimensional problem occurred" << '\n';
+            return *this = Matrix(0);
+        }
+        for (int i = 0; i < n; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                array[i][j] -= ma.array[i][j];
+            }
+        }
+        return *this;
+    }
+
     Matrix operator*(const Matrix& ma)
     {
         if (n == ma.n)
         {
-            vector<vector<int>> temp = vector<vector<int>>(n, vector<int>(ma.n, 0));
-            vector<vector<int>> a1 = ma.array;
-            for (int i = 0; i < n; i++)
+            Matrix Temporary(n);
+            if (n > strassenCrossover)
             {
-                for (int j = 0; j < ma.n; j++)
-                {
-                    for (int c = 0; c < n; c++)
-                    {
-                        temp[i][j] += array[i][c] * a1[c][j];
-                    }
-                }
+                strassenWinograd(n, array.getData(), array.getStride(),
+                                 ma.array.getData(), ma.array.getStride(),
+                                 Temporary.array.getData(), Temporary.array.getStride(), strassenCrossover);
+            } else
+            {
+                gemm(n, ma.n, n, array.getData(), array.getStride(),
+                     ma.array.getData(), ma.array.getStride(),
+                     Temporary.array.getData(), Temporary.array.getStride());
             }
-            Matrix Temporary(n);
-            Temporary.array = temp;
             return Temporary;
         } else
         {
-            cout << "Error: the dimensional problem occurred" << endl;
-            vector<vector<int>> temp = vector<vector<int>>(0, vector<int>(0));
-            Matrix Temporary(0);
-            Temporary.array = temp;
-            return Temporary;
+            stdoutWriter() << "Error: the dimensional problem occurred" << '\n';
+            return Matrix(0);
         }
     }
 
-    void operator=(const Matrix& ma)
+    Matrix(const Matrix& ma) = default;
+    Matrix(Matrix&& ma) = default;
+
+    Matrix& operator=(const Matrix& ma)
     {
         array = ma.array;
         n = ma.n;
+        return *this;
+    }
+
+    Matrix& operator=(Matrix&& ma)
+    {
+        array = std::move(ma.array);
+        n = ma.n;
+        return *this;
+    }
+
+    Matrix& operator*=(const Matrix& ma)
+    {
+        return *this = *this * ma;
     }
 };
 
+int Matrix::strassenCrossover = 512;
+
 int main()
 {
+    if (getenv("MATRIX_STRASSEN_CROSSOVER"))
+    {
+        Matrix::strassenCrossover = atoi(getenv("MATRIX_STRASSEN_CROSSOVER"));
+    }
     int n1, n2, n3;
-    cin >> n1;
+    stdinReader() >> n1;
     Matrix A(n1);
     A.input();
-    cin >> n2;
+    stdinReader() >> n2;
     Matrix B(n2);
     B.input();
-    cin >> n3;
+    stdinReader() >> n3;
     Matrix C(n3);
     C.input();
 
@@ -174,8 +351,9 @@ int main()
     Matrix F = C * A;
     F.output();
 
-    // G = A^T
-    Matrix G = A.transposed();
+    // G = A^T, in place since A is not used any more
+    A.transpose();
+    Matrix& G = A;
     G.output();
     return 0;
 }